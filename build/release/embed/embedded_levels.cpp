@@ -0,0 +1,140 @@
+// Generated by levelconv, do not edit.
+#include <cstddef>
+
+alignas(8) extern const unsigned char EMBEDDED_LEVELS[] = {
+  84, 76, 80, 75, 1, 0, 0, 0, 2, 0, 0, 0, 248, 7, 0, 0,
+  84, 76, 86, 76, 1, 0, 0, 0, 64, 3, 0, 0, 18, 0, 0, 0,
+  32, 0, 0, 0, 0, 0, 160, 67, 0, 0, 72, 67, 0, 0, 160, 66,
+  0, 0, 160, 66, 0, 0, 92, 68, 0, 0, 180, 67, 0, 0, 160, 66,
+  0, 0, 160, 66, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  80, 0, 0, 0, 144, 2, 0, 0, 64, 3, 0, 0, 64, 3, 0, 0,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  0, 0, 230, 67, 0, 0, 130, 67, 0, 0, 32, 65, 0, 0, 0, 0,
+  0, 0, 150, 67, 0, 0, 128, 63, 0, 0, 0, 0, 0, 0, 230, 67,
+  0, 0, 130, 67, 0, 0, 77, 68, 0, 0, 130, 67, 0, 0, 77, 68,
+  0, 0, 150, 67, 0, 0, 32, 65, 0, 0, 0, 0, 0, 0, 150, 67,
+  0, 0, 128, 191, 0, 0, 0, 0, 0, 0, 230, 67, 0, 0, 150, 67,
+  0, 0, 77, 68, 0, 0, 150, 67, 0, 0, 230, 67, 0, 0, 170, 67,
+  0, 0, 32, 65, 0, 0, 0, 0, 0, 0, 150, 67, 0, 0, 128, 63,
+  0, 0, 0, 0, 0, 0, 230, 67, 0, 0, 170, 67, 0, 0, 77, 68,
+  0, 0, 170, 67, 0, 0, 77, 68, 0, 0, 190, 67, 0, 0, 32, 65,
+  0, 0, 0, 0, 0, 0, 150, 67, 0, 0, 128, 191, 0, 0, 0, 0,
+  0, 0, 230, 67, 0, 0, 170, 67, 0, 0, 77, 68, 0, 0, 170, 67,
+  84, 76, 86, 76, 1, 0, 0, 0, 168, 4, 0, 0, 18, 0, 0, 0,
+  32, 0, 0, 0, 0, 0, 160, 67, 0, 0, 160, 67, 0, 0, 160, 66,
+  0, 0, 160, 66, 0, 0, 92, 68, 0, 0, 160, 67, 0, 0, 160, 66,
+  0, 0, 160, 66, 12, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+  80, 0, 0, 0, 144, 2, 0, 0, 160, 4, 0, 0, 168, 4, 0, 0,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 35, 35, 35, 35, 35, 35,
+  35, 35, 35, 35, 35, 35, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46, 46,
+  0, 0, 210, 67, 0, 0, 92, 67, 0, 0, 32, 65, 0, 0, 0, 0,
+  0, 0, 122, 67, 0, 0, 0, 0, 0, 0, 128, 63, 0, 0, 210, 67,
+  0, 0, 92, 67, 0, 0, 210, 67, 0, 0, 250, 67, 0, 0, 230, 67,
+  0, 0, 250, 67, 0, 0, 32, 65, 0, 0, 0, 0, 0, 0, 122, 67,
+  0, 0, 0, 0, 0, 0, 128, 191, 0, 0, 230, 67, 0, 0, 92, 67,
+  0, 0, 230, 67, 0, 0, 250, 67, 0, 0, 250, 67, 0, 0, 92, 67,
+  0, 0, 32, 65, 0, 0, 0, 0, 0, 0, 122, 67, 0, 0, 0, 0,
+  0, 0, 128, 63, 0, 0, 250, 67, 0, 0, 92, 67, 0, 0, 250, 67,
+  0, 0, 250, 67, 0, 0, 7, 68, 0, 0, 250, 67, 0, 0, 32, 65,
+  0, 0, 0, 0, 0, 0, 122, 67, 0, 0, 0, 0, 0, 0, 128, 191,
+  0, 0, 7, 68, 0, 0, 92, 67, 0, 0, 7, 68, 0, 0, 250, 67,
+  0, 0, 17, 68, 0, 0, 92, 67, 0, 0, 32, 65, 0, 0, 0, 0,
+  0, 0, 122, 67, 0, 0, 0, 0, 0, 0, 128, 63, 0, 0, 17, 68,
+  0, 0, 92, 67, 0, 0, 17, 68, 0, 0, 250, 67, 0, 0, 27, 68,
+  0, 0, 250, 67, 0, 0, 32, 65, 0, 0, 0, 0, 0, 0, 122, 67,
+  0, 0, 0, 0, 0, 0, 128, 191, 0, 0, 27, 68, 0, 0, 92, 67,
+  0, 0, 27, 68, 0, 0, 250, 67, 0, 0, 37, 68, 0, 0, 92, 67,
+  0, 0, 32, 65, 0, 0, 0, 0, 0, 0, 122, 67, 0, 0, 0, 0,
+  0, 0, 128, 63, 0, 0, 37, 68, 0, 0, 92, 67, 0, 0, 37, 68,
+  0, 0, 250, 67, 0, 0, 47, 68, 0, 0, 250, 67, 0, 0, 32, 65,
+  0, 0, 0, 0, 0, 0, 122, 67, 0, 0, 0, 0, 0, 0, 128, 191,
+  0, 0, 47, 68, 0, 0, 92, 67, 0, 0, 47, 68, 0, 0, 250, 67,
+  0, 0, 57, 68, 0, 0, 92, 67, 0, 0, 32, 65, 0, 0, 0, 0,
+  0, 0, 122, 67, 0, 0, 0, 0, 0, 0, 128, 63, 0, 0, 57, 68,
+  0, 0, 92, 67, 0, 0, 57, 68, 0, 0, 250, 67, 0, 0, 67, 68,
+  0, 0, 250, 67, 0, 0, 32, 65, 0, 0, 0, 0, 0, 0, 122, 67,
+  0, 0, 0, 0, 0, 0, 128, 191, 0, 0, 67, 68, 0, 0, 92, 67,
+  0, 0, 67, 68, 0, 0, 250, 67, 0, 0, 77, 68, 0, 0, 92, 67,
+  0, 0, 32, 65, 0, 0, 0, 0, 0, 0, 122, 67, 0, 0, 0, 0,
+  0, 0, 128, 63, 0, 0, 77, 68, 0, 0, 92, 67, 0, 0, 77, 68,
+  0, 0, 250, 67, 0, 0, 87, 68, 0, 0, 250, 67, 0, 0, 32, 65,
+  0, 0, 0, 0, 0, 0, 122, 67, 0, 0, 0, 0, 0, 0, 128, 191,
+  0, 0, 87, 68, 0, 0, 92, 67, 0, 0, 87, 68, 0, 0, 250, 67,
+  0, 0, 32, 68, 0, 0, 180, 67, 49, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 16, 0, 0, 0, 64, 3, 0, 0,
+  112, 105, 107, 111, 0, 0, 0, 0, 50, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 80, 3, 0, 0, 168, 4, 0, 0,
+  19, 115, 175, 172, 0, 0, 0, 0,
+};
+extern const size_t EMBEDDED_LEVELS_SIZE = 2136;
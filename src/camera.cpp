@@ -0,0 +1,37 @@
+#include "camera.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "conf.h"
+
+using conf::win;
+
+// Keeps `center` within `half` of `target` and the view of `view_half` inside [lo, hi].
+static float track(float center, float target, float half, float lo, float hi, float view_half) {
+  center = std::clamp(center, target - half, target + half);
+  if (hi - lo <= 2 * view_half) return (lo + hi) / 2;
+  return std::clamp(center, lo + view_half, hi - view_half);
+}
+
+void FollowCamera::follow(vec2 target, Rectangle bounds) {
+  camera.offset = {win.x / 2, win.y / 2};
+  camera.zoom = zoom;
+  vec2 half = deadzone / zoom;
+  vec2 view_half = win / (2 * zoom);
+  camera.target = {
+    track(camera.target.x, target.x, half.x, bounds.x, bounds.x + bounds.width, view_half.x),
+    track(camera.target.y, target.y, half.y, bounds.y, bounds.y + bounds.height, view_half.y),
+  };
+}
+
+// Each step scales by 10%, e.g. one notch of the mouse wheel.
+void FollowCamera::zoom_by(float steps) {
+  zoom = std::clamp(zoom * std::pow(1.1f, steps), MIN_ZOOM, MAX_ZOOM);
+}
+
+Rectangle FollowCamera::view() const {
+  float zoom = camera.zoom;
+  vec2 corner = vec2(camera.target) - vec2(camera.offset) / zoom;
+  return {corner.x, corner.y, win.x / zoom, win.y / zoom};
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <raylib.h>
+
+#include "vec2.h"
+
+// Camera2D following a target. The target moves freely inside the deadzone
+// around the screen center and pushes the camera once it leaves it. The view
+// stays inside the world's bounds, a world smaller than the view is centered.
+class FollowCamera {
+ public:
+  static constexpr float MIN_ZOOM = 0.25f;
+  static constexpr float MAX_ZOOM = 4;
+
+  Camera2D camera = {{0, 0}, {0, 0}, 0, 1};
+  vec2 deadzone = {120, 80};  // half extents in screen pixels
+  float zoom = 1;
+
+  FollowCamera() = default;
+
+  void follow(vec2 target, Rectangle bounds);
+  void zoom_by(float steps);
+  Rectangle view() const;  // the part of the world on screen
+};
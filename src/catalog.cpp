@@ -0,0 +1,168 @@
+#include "catalog.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <unordered_map>
+
+#include "level.h"
+#include "mapcodec.h"
+#include "mapped.h"
+
+namespace fs = std::filesystem;
+
+static int64_t modified(const fs::path& path) {
+  std::error_code ec;
+  auto time = fs::last_write_time(path, ec);
+  return ec ? 0 : time.time_since_epoch().count();
+}
+
+static int64_t level_time(const fs::path& dir) {
+  return std::max(modified(dir / "data.json"), modified(dir / "map.txt"));
+}
+
+// Numbered levels first in numeric order, then everything else by name.
+static bool level_order(const std::string& a, const std::string& b) {
+  auto digit = [](char c) { return std::isdigit((unsigned char)c) != 0; };
+  bool na = !a.empty() && std::all_of(a.begin(), a.end(), digit);
+  bool nb = !b.empty() && std::all_of(b.begin(), b.end(), digit);
+  if (na != nb) return na;
+  if (na && a.size() != b.size()) return a.size() < b.size();
+  return a < b;
+}
+
+// Fills in everything but the name from the map header and the entities of
+// data.json. Whether the level is playable is only known once it's built.
+static void describe(const fs::path& dir, LevelCatalog::Entry& e) {
+  e.time = level_time(dir);
+  try {
+    MapReader map(dir / "map.txt");
+    Level level = Level::entities(dir);
+    e.rows = map.rows;
+    e.cols = map.cols;
+    e.balls = level.obstacles.size();
+    e.coins = level.coins.size();
+    e.checkpoints = level.checkpoints.size();
+    e.broken = 0;
+  } catch (const std::exception& ex) {
+    fprintf(stderr, "catalog: %s\n", ex.what());
+    e.rows = e.cols = e.balls = e.coins = e.checkpoints = 0;
+    e.broken = 1;
+  }
+}
+
+void LevelCatalog::scan(const fs::path& root) {
+  this->root = root;
+  int64_t root_time = modified(root);
+  if (load_index(root_time)) return;
+
+  std::unordered_map<std::string, Entry> cached;
+  for (const auto& e : entries) cached[std::string(e.name, strnlen(e.name, sizeof(e.name)))] = e;
+  entries.clear();
+
+  std::vector<std::string> names;
+  std::error_code ec;
+  for (const auto& item : fs::directory_iterator(root, ec)) {
+    std::string name = item.path().filename().string();
+    if (item.is_directory() && name.size() < sizeof(Entry::name)) names.push_back(name);
+  }
+  std::sort(names.begin(), names.end(), level_order);
+
+  for (const auto& name : names) {
+    auto it = cached.find(name);
+    if (it != cached.end() && it->second.time == level_time(root / name)) {
+      entries.push_back(it->second);
+      continue;
+    }
+
+    Entry& e = entries.emplace_back();
+    std::strncpy(e.name, name.c_str(), sizeof(e.name) - 1);
+    describe(root / name, e);
+  }
+
+  save_index(root_time);
+}
+
+// Revalidate a single level, e.g. after it was edited. Returns whether it changed.
+bool LevelCatalog::refresh(size_t i) {
+  if (i >= entries.size() || entries[i].time == level_time(dir(i))) return false;
+  describe(dir(i), entries[i]);
+  save_index(modified(root));
+  return true;
+}
+
+void LevelCatalog::update(size_t i, const Level& level) {
+  if (i >= entries.size()) return;
+  Entry& e = entries[i];
+  e.rows = level.rows;
+  e.cols = level.cols;
+  e.balls = level.obstacles.size();
+  e.coins = level.coins.size();
+  e.checkpoints = level.checkpoints.size();
+  e.broken = 0;
+  e.time = level_time(dir(i));
+  save_index(modified(root));
+}
+
+fs::path LevelCatalog::dir(size_t i) const {
+  return root / name(i);
+}
+
+std::vector<fs::path> LevelCatalog::dirs() const {
+  std::vector<fs::path> out;
+  out.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) out.push_back(dir(i));
+  return out;
+}
+
+std::string LevelCatalog::name(size_t i) const {
+  return std::string(entries[i].name, strnlen(entries[i].name, sizeof(entries[i].name)));
+}
+
+// Keeps the previous entries around on a stale index so unchanged levels can be reused.
+bool LevelCatalog::load_index(int64_t root_time) {
+  MappedFile f;
+  if (!f.open(root / INDEX) || f.size < sizeof(Header)) return false;
+
+  const Header* h = (const Header*)f.data;
+  if (std::memcmp(h->magic, MAGIC, 4) != 0 || h->version != VERSION ||
+      sizeof(Header) + (uint64_t)h->count * sizeof(Entry) > f.size) {
+    return false;
+  }
+
+  const Entry* begin = (const Entry*)(f.data + sizeof(Header));
+  entries.assign(begin, begin + h->count);
+  return h->root_time == root_time;
+}
+
+void LevelCatalog::save_index(int64_t root_time) const {
+  Header h = {};
+  std::memcpy(h.magic, MAGIC, 4);
+  h.version = VERSION;
+  h.count = entries.size();
+  h.root_time = root_time;
+
+  fs::path path = root / INDEX;
+  fs::path tmp = path;
+  tmp += ".tmp";
+  std::ofstream f(tmp, std::ios::binary);
+  if (!f.is_open()) return;
+  f.write((const char*)&h, sizeof(h));
+  f.write((const char*)entries.data(), entries.size() * sizeof(Entry));
+  f.close();
+  if (!f) return;
+
+  // Renaming over the index touches the root, so remember its new time.
+  std::error_code ec;
+  fs::rename(tmp, path, ec);
+  if (ec) return;
+  int64_t after = modified(root);
+  if (after != root_time) {
+    std::fstream patch(path, std::ios::binary | std::ios::in | std::ios::out);
+    h.root_time = after;
+    patch.write((const char*)&h, sizeof(h));
+  }
+}
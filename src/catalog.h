@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+class Level;
+
+// Metadata of every level directory under a root, cached in a binary index.
+// While the root's modification time matches the index nothing under it is
+// touched, otherwise the directory is listed again and only levels whose files
+// changed are re-read. Levels are described from the map header and data.json,
+// without building them. Edits while running are picked up through `update`
+// and `refresh`. Levels that can't be read keep their place, flagged `broken`,
+// so the numbering doesn't shift.
+class LevelCatalog {
+ public:
+  static constexpr const char* INDEX = "catalog.bin";
+  static constexpr char MAGIC[4] = {'T', 'L', 'C', 'T'};
+  static constexpr uint32_t VERSION = 3;
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+    int64_t root_time;
+  };
+
+  struct Entry {
+    char name[32];
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t balls;
+    uint32_t coins;
+    uint32_t checkpoints;
+    uint32_t broken;  // 1 when the level couldn't be read, the counts are then 0
+    int64_t time;     // newest modification time of the two
+  };
+
+  std::filesystem::path root;
+  std::vector<Entry> entries;
+
+  LevelCatalog() = default;
+
+  void scan(const std::filesystem::path& root);
+  bool refresh(size_t i);
+  void update(size_t i, const Level& level);  // after the level was reloaded
+  std::filesystem::path dir(size_t i) const;
+  std::vector<std::filesystem::path> dirs() const;
+  std::string name(size_t i) const;
+
+ private:
+  bool load_index(int64_t root_time);
+  void save_index(int64_t root_time) const;
+};
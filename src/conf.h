@@ -4,10 +4,14 @@
 
 namespace conf {
 
-const vec2 win = {1280, 720};
-const int SIZE = 40;
-const int COLS = win.x / SIZE;
-const int ROWS = win.y / SIZE;
+// Size of the stock levels, the window fits exactly one of them.
+constexpr int SIZE = 40;
+constexpr int COLS = 1280 / SIZE;
+constexpr int ROWS = 720 / SIZE;
+const vec2 win = {COLS * SIZE, ROWS * SIZE};
+// The simulation advances in fixed steps, drawing blends between the last two.
+constexpr float TICK = 1.0f / 60;
+constexpr float MAX_FRAME_TIME = 0.25f;  // longer frames drop time instead of catching up
 const Color BG_COLOR = GetColor(0x67a0bfff);
 const Color GRID_COLOR = GetColor(0xbcc2beff);
 const std::pair<Color, Color> TILE_COLORS = {GetColor(0xe3e3e3ff), GetColor(0xc7c7c7ff)};
@@ -0,0 +1,70 @@
+#include "flowfield.h"
+
+#include "conf.h"
+
+using conf::SIZE;
+
+static const int DIRS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+bool FlowField::update(const std::vector<std::vector<char>>& map, vec2 target) {
+  this->target = target;
+  int tr = target.y / SIZE, tc = target.x / SIZE;
+  if (tr == target_row && tc == target_col && !dist.empty()) return false;
+
+  rows = map.size();
+  cols = rows > 0 ? map[0].size() : 0;
+  target_row = tr;
+  target_col = tc;
+  dist.assign(rows * cols, UNREACHABLE);
+  next.assign(rows * cols, -1);
+
+  if (tr < 0 || tr >= rows || tc < 0 || tc >= cols || map[tr][tc] != '#') return true;
+
+  // Flat BFS queue, every cell is pushed at most once.
+  std::vector<int> queue;
+  queue.reserve(rows * cols);
+  queue.push_back(tr * cols + tc);
+  dist[tr * cols + tc] = 0;
+
+  for (size_t head = 0; head < queue.size(); head++) {
+    int cell = queue[head];
+    int r = cell / cols, c = cell % cols;
+    for (int d = 0; d < 4; d++) {
+      int nr = r + DIRS[d][0], nc = c + DIRS[d][1];
+      if (nr < 0 || nr >= rows || nc < 0 || nc >= cols || map[nr][nc] != '#') continue;
+      int n = nr * cols + nc;
+      if (dist[n] != UNREACHABLE) continue;
+      dist[n] = dist[cell] + 1;
+      next[n] = d ^ 1;  // step back towards `cell`
+      queue.push_back(n);
+    }
+  }
+
+  return true;
+}
+
+// Force a rebuild on the next update, e.g. after the tiles changed.
+void FlowField::reset() {
+  rows = 0;
+  cols = 0;
+  target_row = -1;
+  target_col = -1;
+  dist.clear();
+  next.clear();
+}
+
+uint32_t FlowField::distance(int row, int col) const {
+  if (row < 0 || row >= rows || col < 0 || col >= cols) return UNREACHABLE;
+  return dist[row * cols + col];
+}
+
+vec2 FlowField::steer(vec2 pos) const {
+  int r = pos.y / SIZE, c = pos.x / SIZE;
+  uint32_t d = distance(r, c);
+  if (d == UNREACHABLE) return {};
+  if (d == 0) return (target - pos).norm();
+
+  int step = next[r * cols + c];
+  vec2 center = {(c + DIRS[step][1] + 0.5f) * SIZE, (r + DIRS[step][0] + 0.5f) * SIZE};
+  return (center - pos).norm();
+}
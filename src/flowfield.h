@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "vec2.h"
+
+// Breadth first distance field towards a single target tile, shared by every
+// chaser of a level. Rebuilt only when the target moves to a different tile.
+class FlowField {
+ public:
+  static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+  int rows = 0;
+  int cols = 0;
+  vec2 target;
+  int target_row = -1;
+  int target_col = -1;
+  std::vector<uint32_t> dist;
+  std::vector<int8_t> next;  // index into `DIRS`, -1 when at the target or unreachable
+
+  FlowField() = default;
+
+  bool update(const std::vector<std::vector<char>>& map, vec2 target);
+  void reset();
+  uint32_t distance(int row, int col) const;
+  vec2 steer(vec2 pos) const;
+};
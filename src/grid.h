@@ -0,0 +1,39 @@
+#pragma once
+
+#include <bit>
+
+// Read only view of a level's tiles, stored row major with the row stride
+// rounded up to a power of two so a lookup is a shift and an add. With
+// `Rows`/`Cols` set the size is a compile time constant, which is what the
+// stock levels use; the default reads it from the view.
+template <int Rows = 0, int Cols = 0>
+struct TileGrid {
+  static constexpr bool FIXED = Rows > 0 && Cols > 0;
+  static constexpr int FIXED_SHIFT = FIXED ? std::bit_width((unsigned)Cols - 1) : 0;
+
+  const char* tiles;
+  int dyn_rows = Rows;
+  int dyn_cols = Cols;
+  int dyn_shift = FIXED_SHIFT;
+
+  int rows() const {
+    if constexpr (FIXED) return Rows;
+    else return dyn_rows;
+  }
+
+  int cols() const {
+    if constexpr (FIXED) return Cols;
+    else return dyn_cols;
+  }
+
+  int shift() const {
+    if constexpr (FIXED) return FIXED_SHIFT;
+    else return dyn_shift;
+  }
+
+  // Out of bounds reads as a wall.
+  char get(int row, int col) const {
+    if ((unsigned)row >= (unsigned)rows() || (unsigned)col >= (unsigned)cols()) return '.';
+    return tiles[(row << shift()) + col];
+  }
+};
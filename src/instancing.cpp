@@ -0,0 +1,107 @@
+#include "instancing.h"
+
+#include <raymath.h>
+#include <rlgl.h>
+
+#include <algorithm>
+
+// Every instance is a quad of two triangles around its center, the corners
+// come from the vertex id so only the per instance buffer is needed. They wind
+// counter clockwise on screen like raylib's own quads, anything else is culled.
+static const char* VERTEX_SHADER = R"(#version 330
+layout(location = 0) in vec3 instance;  // x, y, radius
+layout(location = 1) in vec4 tint;
+uniform mat4 mvp;
+uniform vec4 cell;  // x, y, width, height in texture coordinates
+out vec2 uv;
+out vec4 color;
+
+const vec2 CORNERS[6] = vec2[6](
+  vec2(-1, -1), vec2(-1, 1), vec2(1, 1),
+  vec2(-1, -1), vec2(1, 1), vec2(1, -1)
+);
+
+void main() {
+  vec2 corner = CORNERS[gl_VertexID];
+  uv = cell.xy + (corner * 0.5 + 0.5) * cell.zw;
+  color = tint;
+  gl_Position = mvp * vec4(instance.xy + corner * instance.z, 0, 1);
+}
+)";
+
+static const char* FRAGMENT_SHADER = R"(#version 330
+in vec2 uv;
+in vec4 color;
+uniform sampler2D atlas;
+out vec4 frag;
+
+void main() {
+  frag = texture(atlas, uv) * color;
+}
+)";
+
+void SpriteInstancer::load() {
+  loaded = true;
+  shader = LoadShaderFromMemory(VERTEX_SHADER, FRAGMENT_SHADER);
+  // raylib hands back its default shader when compiling fails.
+  if (shader.id == 0 || shader.id == rlGetShaderIdDefault()) {
+    shader = {};
+    return;
+  }
+  mvp_loc = GetShaderLocation(shader, "mvp");
+  cell_loc = GetShaderLocation(shader, "cell");
+  atlas_loc = GetShaderLocation(shader, "atlas");
+  vao = rlLoadVertexArray();
+}
+
+bool SpriteInstancer::ready() {
+  if (!loaded) load();
+  return shader.id != 0;
+}
+
+void SpriteInstancer::upload(const Instance* instances, size_t count) {
+  if (count > capacity) {
+    if (vbo != 0) rlUnloadVertexBuffer(vbo);
+    capacity = std::max({count, capacity * 2, (size_t)1024});
+    vbo = rlLoadVertexBuffer(nullptr, capacity * sizeof(Instance), true);
+  }
+  rlUpdateVertexBuffer(vbo, instances, count * sizeof(Instance), 0);
+}
+
+void SpriteInstancer::draw(Texture2D atlas, Rectangle source, size_t first, size_t count) {
+  if (count == 0) return;
+  // Whatever raylib batched so far goes first so the order holds.
+  rlDrawRenderBatchActive();
+
+  Matrix model_view = MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview());
+  float cell[4] = {
+    source.x / atlas.width,
+    source.y / atlas.height,
+    source.width / atlas.width,
+    source.height / atlas.height,
+  };
+  int slot = 0;
+
+  rlEnableShader(shader.id);
+  rlSetUniformMatrix(mvp_loc, MatrixMultiply(model_view, rlGetMatrixProjection()));
+  rlSetUniform(cell_loc, cell, RL_SHADER_UNIFORM_VEC4, 1);
+  rlSetUniform(atlas_loc, &slot, RL_SHADER_UNIFORM_INT, 1);
+  rlActiveTextureSlot(0);
+  rlEnableTexture(atlas.id);
+
+  rlEnableVertexArray(vao);
+  rlEnableVertexBuffer(vbo);
+  int offset = first * sizeof(Instance);
+  rlSetVertexAttribute(0, 3, RL_FLOAT, false, sizeof(Instance), offset);
+  rlSetVertexAttribute(1, 4, RL_UNSIGNED_BYTE, true, sizeof(Instance), offset + 3 * sizeof(float));
+  for (unsigned int i = 0; i < 2; i++) {
+    rlEnableVertexAttribute(i);
+    rlSetVertexAttributeDivisor(i, 1);
+  }
+  rlDrawVertexArrayInstanced(0, 6, count);
+
+  rlDisableVertexBuffer();
+  rlDisableVertexArray();
+  rlDisableTexture();
+  rlDisableShader();
+}
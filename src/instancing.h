@@ -0,0 +1,44 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Draws many copies of one atlas cell with a single instanced draw call. The
+// instances of a frame are uploaded once, then each sprite type draws its
+// range of them. Needs OpenGL 3.3, `ready()` is false when the shader didn't
+// compile and the caller should fall back to textured quads.
+//
+// The GL objects are never freed, they live as long as the window.
+class SpriteInstancer {
+ public:
+  struct Instance {
+    float x;
+    float y;
+    float radius;
+    Color color;  // multiplied with the sprite
+  };
+
+  SpriteInstancer() = default;
+  SpriteInstancer(const SpriteInstancer&) = delete;
+  SpriteInstancer& operator=(const SpriteInstancer&) = delete;
+
+  bool ready();
+  void upload(const Instance* instances, size_t count);
+  // Draws `count` uploaded instances starting at `first` as `source` of `atlas`,
+  // through raylib's current camera.
+  void draw(Texture2D atlas, Rectangle source, size_t first, size_t count);
+
+ private:
+  bool loaded = false;
+  Shader shader = {};
+  int mvp_loc = -1;
+  int cell_loc = -1;
+  int atlas_loc = -1;
+  unsigned int vao = 0;
+  unsigned int vbo = 0;
+  size_t capacity = 0;  // instances the buffer holds
+
+  void load();
+};
@@ -1,13 +1,23 @@
 #include "level.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <filesystem>
 #include <fstream>
+#include <stdexcept>
 
 #include "conf.h"
+#include "levelfile.h"
+#include "mapcodec.h"
+#include "mapped.h"
 #include "serde.h"
 
-using conf::SIZE, conf::TILE_COLORS, conf::CHECKPOINT_COLOR;
+using conf::SIZE, conf::CHECKPOINT_COLOR;
 
-Linear::Linear(vec2 dir, float speed, Bounds bounds) : dir(dir), speed(speed), bounds(bounds) {}
+Linear::Linear(vec2 dir, float speed, Bounds bounds) : dir(dir), speed(speed), bounds(bounds) {
+  kind = Move::Linear;
+}
 
 void Linear::update(float dt, vec2& pos) {
   pos += dir * speed * dt;
@@ -15,20 +25,33 @@ void Linear::update(float dt, vec2& pos) {
   if (dir.y != 0 && (pos.y <= bounds.min.y || pos.y >= bounds.max.y)) dir.y *= -1;
 }
 
+Chaser::Chaser(float speed, vec2 home) : speed(speed), home(home) {
+  kind = Move::Chaser;
+}
+
+void Chaser::update(float dt, vec2& pos) {
+  if (!field) return;
+  pos += field->steer(pos) * speed * dt;
+}
+
 void Circle::update(float dt) {
+  prev = pos;
   move->update(dt, pos);
 }
 
-void Circle::draw() const {
-  DrawCircleV(pos, radius, BLUE);
-  DrawCircleLinesV(pos, radius, BLACK);
+void Circle::draw(RenderQueue& queue) const {
+  queue.sprite(Layer::Entities, Sprite::Ball, pos, radius);
 }
 
 Coin::Coin(vec2 pos) : pos(pos) {}
 
-void Coin::draw() const {
-  DrawCircleV(pos, radius, YELLOW);
-  DrawCircleLinesV(pos, radius, BLACK);
+void Coin::draw(RenderQueue& queue) const {
+  queue.sprite(Layer::Entities, Sprite::Coin, pos, radius);
+}
+
+// `alpha` of the way from the previous to the current position.
+void EntityState::draw(RenderQueue& queue, float alpha) const {
+  queue.sprite(Layer::Entities, sprite, prev + (pos - prev) * alpha, radius);
 }
 
 vec2 tiled(vec2 v) {
@@ -43,125 +66,333 @@ Rectangle tiled(Rectangle r) {
   return r;
 }
 
-Level::Level(int id) : map(conf::ROWS, std::vector<char>(conf::COLS, 0)) {
-  std::filesystem::path path = "levels";
-  path.append(std::to_string(id));
+// Flood fill the floor into 4-connected components, the player can't squeeze
+// through diagonal gaps so corners don't connect.
+static void label_regions(Level& level) {
+  int rows = level.map.size(), cols = level.map[0].size();
+  level.regions.assign(rows * cols, -1);
+  level.region_count = 0;
+
+  std::vector<int> stack;
+  for (int i = 0; i < rows * cols; i++) {
+    if (level.regions[i] != -1 || level.map[i / cols][i % cols] != '#') continue;
 
-  std::ifstream f(path / "data.json");
-  if (f.is_open()) {
-    json j = json::parse(f);
-    start = tiled(j["start"].template get<Rectangle>());
-    finish = tiled(j["finish"].template get<Rectangle>());
-    obstacles = j["balls"].template get<std::vector<Circle>>();
-    if (j.contains("coins")) {
-      for (auto& c : j["coins"]) coins.emplace_back(tiled(c.template get<vec2>()));
+    int label = level.region_count++;
+    level.regions[i] = label;
+    stack.push_back(i);
+    while (!stack.empty()) {
+      int cell = stack.back();
+      stack.pop_back();
+      int r = cell / cols, c = cell % cols;
+      int neighbours[4][2] = {{r - 1, c}, {r + 1, c}, {r, c - 1}, {r, c + 1}};
+      for (auto [nr, nc] : neighbours) {
+        if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+        int n = nr * cols + nc;
+        if (level.regions[n] != -1 || level.map[nr][nc] != '#') continue;
+        level.regions[n] = label;
+        stack.push_back(n);
+      }
     }
-    std::cout << coins.size() << '\n';
-    f.close();
   }
+}
+
+// Cover the wall tiles with as few rectangles as possible: grow each
+// unclaimed tile right as far as it goes, then down while the whole span is free.
+static void merge_walls(Level& level) {
+  int rows = level.map.size(), cols = level.map[0].size();
+  level.walls.clear();
+  std::vector<bool> claimed(rows * cols);
+
+  auto free = [&](int r, int c) { return level.map[r][c] != '#' && !claimed[r * cols + c]; };
+
+  for (int r = 0; r < rows; r++) {
+    for (int c = 0; c < cols; c++) {
+      if (!free(r, c)) continue;
+
+      int w = 1;
+      while (c + w < cols && free(r, c + w)) w++;
+
+      int h = 1;
+      for (; r + h < rows; h++) {
+        bool span = true;
+        for (int x = c; x < c + w && span; x++) span = free(r + h, x);
+        if (!span) break;
+      }
+
+      for (int y = r; y < r + h; y++) {
+        for (int x = c; x < c + w; x++) claimed[y * cols + x] = true;
+      }
+      level.walls.push_back(tiled(Rectangle{(float)c, (float)r, (float)w, (float)h}));
+    }
+  }
+}
+
+static void build_index(Level& level) {
+  std::vector<SpatialIndex::Item> items;
+  items.reserve(level.walls.size() + level.coins.size() + level.checkpoints.size());
+  for (size_t i = 0; i < level.walls.size(); i++) {
+    items.push_back({level.walls[i], SpatialIndex::Walls, (int)i});
+  }
+  for (size_t i = 0; i < level.coins.size(); i++) {
+    const Coin& coin = level.coins[i];
+    Rectangle bounds = {
+      coin.pos.x - coin.radius,
+      coin.pos.y - coin.radius,
+      coin.radius * 2,
+      coin.radius * 2
+    };
+    items.push_back({bounds, SpatialIndex::Coins, (int)i});
+  }
+  for (size_t i = 0; i < level.checkpoints.size(); i++) {
+    items.push_back({level.checkpoints[i], SpatialIndex::Checkpoints, (int)i});
+  }
+  level.index.build(std::move(items));
+}
+
+static vec2 center(Rectangle r) {
+  return {r.x + r.width / 2, r.y + r.height / 2};
+}
+
+// Reject levels whose goals can't be reached from the start.
+static void validate(const Level& level, const std::string& name) {
+  auto fail = [&name](const std::string& what) {
+    throw std::runtime_error(name + ": " + what);
+  };
+
+  int home = level.region(center(level.start));
+  if (home == -1) fail("start is not on floor");
+  if (!level.reaches(home, level.finish)) fail("finish is not reachable from start");
+  for (size_t i = 0; i < level.checkpoints.size(); i++) {
+    if (!level.reaches(home, level.checkpoints[i])) {
+      fail("checkpoint " + std::to_string(i) + " is not reachable from start");
+    }
+  }
+  for (const auto& coin : level.coins) {
+    Rectangle bounds = {
+      coin.pos.x - coin.radius,
+      coin.pos.y - coin.radius,
+      coin.radius * 2,
+      coin.radius * 2
+    };
+    if (!level.reaches(home, bounds)) fail("coin is not reachable from start");
+  }
+}
+
+// Parse data.json, positions in the json are in tiles.
+static void read_data(Level& level, const std::filesystem::path& dir) {
+  MappedFile data;
+  if (data.open(dir / "data.json")) {
+    LevelSax sax(level);
+    if (!json::sax_parse(data.data, data.data + data.size, &sax)) {
+      throw std::runtime_error((dir / "data.json").string() + ": " + sax.error);
+    }
+  }
+}
+
+static void read_map(Level& level, const std::filesystem::path& dir) {
+  std::filesystem::path path = dir / "map.txt";
+  MappedFile file;
+  if (!file.open(path)) throw std::runtime_error(path.string() + ": missing or empty");
+  level.map = parse_map(file.data, file.size, path.string());
+}
+
+// Copy the map into the flat `tiles` with a power of two row stride.
+static void flatten(Level& level) {
+  level.rows = level.map.size();
+  level.cols = level.rows > 0 ? level.map[0].size() : 0;
+  level.shift = level.cols > 1 ? std::bit_width((unsigned)level.cols - 1) : 0;
+  level.tiles.assign((size_t)level.rows << level.shift, '.');
+  for (int r = 0; r < level.rows; r++) {
+    std::copy(level.map[r].begin(), level.map[r].end(), level.tiles.begin() + (r << level.shift));
+  }
+}
+
+// The binary file caches the text sources, trust it only while it's newer than both.
+static bool binary_is_fresh(const std::filesystem::path& dir) {
+  std::error_code ec;
+  auto bin_time = std::filesystem::last_write_time(dir / LevelFile::NAME, ec);
+  if (ec) return false;
+  for (auto name : {"data.json", "map.txt"}) {
+    auto time = std::filesystem::last_write_time(dir / name, ec);
+    if (!ec && time > bin_time) return false;
+  }
+  return true;
+}
+
+Level::Level(int id) : Level(std::filesystem::path("levels") / std::to_string(id)) {}
+
+static void link_chasers(Level& level) {
+  for (auto& obs : level.obstacles) {
+    if (obs.move->kind == Move::Chaser) ((Chaser*)obs.move.get())->field = level.flow;
+  }
+}
+
+// Unique across all levels, they may be built on other threads.
+static uint64_t next_revision() {
+  static std::atomic<uint64_t> counter = 0;
+  return ++counter;
+}
+
+// Everything derived from the raw map and entities, shared by all loaders.
+static void prepare(Level& level, const std::string& name) {
+  link_chasers(level);
+  flatten(level);
+  level.runs.build(level.tiles.data(), level.rows, level.cols, 1 << level.shift);
+  label_regions(level);
+  merge_walls(level);
+  build_index(level);
+  validate(level, name);
+  level.coins_left = level.coins.size();
+  level.revision = next_revision();
+
+  // Chasers first head for the spawn, so the field can be ready before play starts.
+  level.flow->update(level.map, center(level.start));
+}
 
-  std::ifstream file(path / "map.txt");
-  if (file.is_open()) {
-    std::string line;
-    for (size_t y = 0; std::getline(file, line); y++) {
-      for (size_t x = 0; x < line.size(); x++) {
-        map[y][x] = line[x];
+Level::Level(const std::filesystem::path& dir) {
+  LevelFile file;
+  if (binary_is_fresh(dir) && file.open(dir / LevelFile::NAME)) {
+    file.read(*this);
+  } else {
+    read_data(*this, dir);
+    read_map(*this, dir);
+  }
+  prepare(*this, dir.string());
+}
+
+Level::Level(const LevelFile& file, const std::string& name) {
+  file.read(*this);
+  prepare(*this, name);
+}
+
+Level Level::entities(const std::filesystem::path& dir) {
+  Level level;
+  read_data(level, dir);
+  return level;
+}
+
+// Re-read the changed sources and rebuild only what depends on them. The
+// update is staged on a copy so a level that fails validation stays untouched.
+void Level::reload(const std::filesystem::path& dir, int changes) {
+  Level next = *this;
+
+  if (changes & Tiles) {
+    read_map(next, dir);
+    if (next.map == map) changes &= ~Tiles;
+  }
+
+  if (changes & Entities) {
+    next.obstacles.clear();
+    next.coins.clear();
+    read_data(next, dir);
+    link_chasers(next);
+    next.coins_left = next.coins.size();
+  }
+
+  if (changes & Tiles) {
+    flatten(next);
+    if (next.rows == rows && next.cols == cols) {
+      for (int r = 0; r < rows; r++) {
+        if (next.map[r] != map[r]) next.runs.update_row(r, next.map[r].data(), cols);
       }
+    } else {
+      next.runs.build(next.tiles.data(), next.rows, next.cols, 1 << next.shift);
     }
-    file.close();
+    label_regions(next);
+    merge_walls(next);
   }
+
+  if (!changes) return;
+  build_index(next);
+  validate(next, dir.string());
+  next.revision = next_revision();
+
+  *this = std::move(next);
+  if (changes & Tiles) flow->reset();
+}
+
+void Level::save(const std::filesystem::path& dir, bool rle) const {
+  std::ofstream f(dir / "map.txt");
+  if (!f.is_open()) return;
+  f << (rle ? format_map_rle(map) : format_map_plain(map));
+
+  std::ofstream d(dir / "data.json");
+  if (!d.is_open()) return;
+  json j = json::object();
+  j["start"] = {start.x / SIZE, start.y / SIZE, start.width / SIZE, start.height / SIZE};
+  j["finish"] = {finish.x / SIZE, finish.y / SIZE, finish.width / SIZE, finish.height / SIZE};
+  j["balls"] = json::array();
+  for (auto& obs : obstacles) j["balls"].push_back(obs);
+  for (auto& coin : coins) j["coins"].push_back(coin.pos / SIZE);
+
+  d << j.dump(2);
+}
+
+Rectangle Level::bounds() const {
+  return {0, 0, (float)cols * SIZE, (float)rows * SIZE};
+}
+
+int Level::region(int row, int col) const {
+  if (row < 0 || row >= rows || col < 0 || col >= cols) return -1;
+  return regions[row * cols + col];
+}
+
+int Level::region(vec2 pos) const {
+  return region(std::floor(pos.y / SIZE), std::floor(pos.x / SIZE));
 }
 
-char Level::get(int row, int col) const {
-  if (row < 0 || row >= conf::ROWS || col < 0 || col >= conf::COLS) return '.';
-  return map[row][col];
+bool Level::connected(vec2 a, vec2 b) const {
+  int ra = region(a);
+  return ra != -1 && ra == region(b);
+}
+
+// Whether any floor tile touched by `rect` belongs to `region`.
+bool Level::reaches(int region, Rectangle rect) const {
+  if (region == -1) return false;
+  int row_end = std::ceil((rect.y + rect.height) / SIZE);
+  int col_end = std::ceil((rect.x + rect.width) / SIZE);
+  for (int r = std::floor(rect.y / SIZE); r < row_end; r++) {
+    for (int c = std::floor(rect.x / SIZE); c < col_end; c++) {
+      if (this->region(r, c) == region) return true;
+    }
+  }
+  return false;
 }
 
 void Level::set_player(vec2& pos, vec2 size) {
   Rectangle check = current_checkpoint == -1 ? start : checkpoints[current_checkpoint];
   pos.x = check.x + check.width / 2 - size.x / 2;
   pos.y = check.y + check.height / 2 - size.y / 2;
+
+  // Chasers restart from their spawn so they can't camp the respawn point.
+  for (auto& obs : obstacles) {
+    if (obs.move->kind == Move::Chaser) obs.pos = obs.prev = ((Chaser*)obs.move.get())->home;
+  }
 }
 
-void Level::update(float dt) {
+void Level::update(float dt, vec2 target) {
+  flow->update(map, target);
   for (auto& obs : obstacles) obs.update(dt);
 }
 
-void Level::draw() const {
-  for (size_t y = 0; y < map.size(); y++) {
-    for (size_t x = 0; x < map[0].size(); x++) {
-      if (map[y][x] == '#') {
-        DrawRectangle(
-          x * SIZE,
-          y * SIZE,
-          SIZE,
-          SIZE,
-          (x + y) % 2 == 0 ? TILE_COLORS.first : TILE_COLORS.second
-        );
-      }
-    }
+// Tiles and markers, cached by the game until `revision` changes.
+void Level::draw_static(RenderQueue& queue, Rectangle view) const {
+  runs.draw(queue, view);
+  for (Rectangle rect : {start, finish}) {
+    if (CheckCollisionRecs(rect, view)) queue.rect(Layer::Markers, rect, CHECKPOINT_COLOR);
   }
+  index.query(view, SpatialIndex::Checkpoints, [&](const SpatialIndex::Item& item) {
+    queue.rect(Layer::Markers, checkpoints[item.index], CHECKPOINT_COLOR);
+  });
+}
 
-  DrawRectangleRec(start, CHECKPOINT_COLOR);
-  DrawRectangleRec(finish, CHECKPOINT_COLOR);
-
-  for (const auto& obs : obstacles) obs.draw();
-  for (const auto& coin : coins) coin.draw();
-}
-
-LevelManager::LevelManager(int level_count) {
-  for (int id = 1; id <= level_count; id++) {
-    levels.emplace_back(id);
-  }
-}
-
-Level* LevelManager::get(size_t level_num) {
-  if (level_num > levels.size()) return nullptr;
-  index = level_num - 1;
-  return current();
-}
-
-Level* LevelManager::current() {
-  return &levels[index];
-}
-
-Level* LevelManager::next() {
-  index++;
-  if (index < levels.size()) return current();
-  return nullptr;
-}
-
-// static void createPerimeter(Level& level) {
-//   int rows = level.map.size();
-//   int cols = level.map[0].size();
-//
-//   level.perimeter.clear();
-//
-//   for (int y = 0; y < rows; y++) {
-//     for (int x = 0; x < cols; x++) {
-//       if (level.map[y][x] == 0) continue;
-//
-//       float wx = x * tile_size;
-//       float wy = y * tile_size;
-//
-//       bool is_edge = (x == 0 || x == cols - 1 || y == 0 || y == rows - 1);
-//       bool adj = level.isWall(x - 1, y) || level.isWall(x + 1, y) || level.isWall(x, y - 1) ||
-//                  level.isWall(x, y + 1);
-//
-//       if (is_edge || adj) {
-//         if (y == 0 || level.map[y - 1][x] == 0) {
-//           level.perimeter.push_back({{wx, wy}, {wx + tile_size, wy}});
-//         }
-//         if (y == rows - 1 || level.map[y + 1][x] == 0) {
-//           level.perimeter.push_back({{wx, wy + tile_size}, {wx + tile_size, wy + tile_size}});
-//         }
-//         if (x == 0 || level.map[y][x - 1] == 0) {
-//           level.perimeter.push_back({{wx, wy}, {wx, wy + tile_size}});
-//         }
-//         if (x == cols - 1 || level.map[y][x + 1] == 0) {
-//           level.perimeter.push_back({{wx + tile_size, wy}, {wx + tile_size, wy + tile_size}});
-//         }
-//       }
-//     }
-//   }
-// }
+void Level::capture(std::vector<EntityState>& entities, Rectangle area) const {
+  for (const auto& obs : obstacles) {
+    if (!CheckCollisionCircleRec(obs.pos, obs.radius, area)) continue;
+    entities.push_back({obs.pos, obs.prev, obs.radius, Sprite::Ball});
+  }
+  index.query(area, SpatialIndex::Coins, [&](const SpatialIndex::Item& item) {
+    const Coin& coin = coins[item.index];
+    if (!coin.collected) entities.push_back({coin.pos, coin.pos, coin.radius, Sprite::Coin});
+  });
+}
@@ -2,14 +2,23 @@
 
 #include <raylib.h>
 
+#include <filesystem>
+#include <memory>
 #include <vector>
 
+#include "conf.h"
+#include "flowfield.h"
+#include "grid.h"
+#include "render.h"
+#include "spatial.h"
+#include "tileruns.h"
 #include "vec2.h"
 
 class Move {
  public:
   enum Kind {
-    Linear
+    Linear,
+    Chaser
   };
   Kind kind;
   virtual void update(float dt, vec2& pos) = 0;
@@ -32,50 +41,117 @@ class Linear : public Move {
   void update(float dt, vec2& pos) override;
 };
 
+// Follows the level's shared flow field towards the player, never leaving floor tiles.
+class Chaser : public Move {
+ public:
+  float speed;
+  vec2 home;
+  std::shared_ptr<const FlowField> field;
+
+  Chaser(float speed, vec2 home);
+
+  void update(float dt, vec2& pos) override;
+};
+
 struct Circle {
   vec2 pos;
+  vec2 prev;  // `pos` before the last update, for interpolated drawing
   float radius = 10;
   std::shared_ptr<Move> move;
 
   void update(float dt);
-  void draw() const;
+  void draw(RenderQueue& queue) const;
 };
 
 struct Coin {
   vec2 pos;
   float radius = 7.5;
+  bool collected = false;
 
   Coin(vec2 pos);
 
-  void draw() const;
+  void draw(RenderQueue& queue) const;
+};
+
+// A ball or coin as one simulation tick left it, so it can be drawn while
+// the simulation runs on.
+struct EntityState {
+  vec2 pos;
+  vec2 prev;
+  float radius;
+  Sprite sprite;
+
+  void draw(RenderQueue& queue, float alpha) const;
 };
 
+class LevelFile;
+
 class Level {
  public:
+  enum Change {
+    Tiles = 1 << 0,     // map.txt
+    Entities = 1 << 1,  // data.json
+  };
+
   std::vector<std::vector<char>> map;
+  int rows = 0;
+  int cols = 0;
+  int shift = 0;            // log2 of the row stride of `tiles`
+  std::vector<char> tiles;  // `map` flattened for lookups, see TileGrid
+  TileRuns runs;            // floor runs for drawing
   Rectangle start;
   Rectangle finish;
   std::vector<Circle> obstacles;
   std::vector<Rectangle> checkpoints;
   std::vector<Coin> coins;
+  int coins_left = 0;
   int current_checkpoint = -1;
+  std::shared_ptr<FlowField> flow = std::make_shared<FlowField>();
+  std::vector<int> regions;  // connected floor component of each tile, -1 for walls
+  int region_count = 0;
+  // Wall tiles greedily merged into maximal rectangles. The spatial index holds
+  // them and player sweeps query those boxes instead of reading tiles.
+  std::vector<Rectangle> walls;
+  SpatialIndex index;
+  uint64_t revision = 0;  // changes whenever what `draw_static` draws does
 
   Level(int id);
-
-  char get(int row, int col) const;
+  Level(const std::filesystem::path& dir);
+  Level(const LevelFile& file, const std::string& name);
+
+  // Only the entities of data.json, without a map or anything derived from it.
+  static Level entities(const std::filesystem::path& dir);
+
+  // Inline since it's called per tile by collision and raycasts.
+  char get(int row, int col) const {
+    if ((unsigned)row >= (unsigned)rows || (unsigned)col >= (unsigned)cols) return '.';
+    return tiles[(row << shift) + col];
+  }
+
+  // Calls `f(grid)` with the TileGrid specialized for this level's size, so
+  // loops over many tiles dispatch once instead of per lookup.
+  template <typename F>
+  decltype(auto) with_grid(F&& f) const {
+    if (rows == conf::ROWS && cols == conf::COLS) {
+      return f(TileGrid<conf::ROWS, conf::COLS>{tiles.data()});
+    }
+    return f(TileGrid<>{tiles.data(), rows, cols, shift});
+  }
+
+  Rectangle bounds() const;
+  int region(int row, int col) const;
+  int region(vec2 pos) const;
+  bool connected(vec2 a, vec2 b) const;
+  bool reaches(int region, Rectangle rect) const;
+  void reload(const std::filesystem::path& dir, int changes);
+  void save(const std::filesystem::path& dir, bool rle = false) const;
   void set_player(vec2& pos, vec2 size);
-  void update(float dt);
-  void draw() const;
-};
-
-class LevelManager {
- public:
-  std::vector<Level> levels;
-  size_t index = 0;
-
-  LevelManager(int level_count);
-
-  Level* get(size_t level_num);
-  Level* current();
-  Level* next();
+  void update(float dt, vec2 target);
+  // Only records what overlaps `view`, a rectangle in world pixels.
+  void draw_static(RenderQueue& queue, Rectangle view) const;
+  // Appends the balls and live coins overlapping `area`.
+  void capture(std::vector<EntityState>& entities, Rectangle area) const;
+
+ private:
+  Level() = default;
 };
@@ -0,0 +1,167 @@
+#include "levelfile.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+static uint32_t align(uint32_t n) {
+  return (n + 3) & ~3u;
+}
+
+bool LevelFile::open(const std::filesystem::path& path) {
+  close();
+  if (!file.open(path)) return false;
+  if (view(file.data, file.size)) return true;
+  close();
+  return false;
+}
+
+bool LevelFile::view(const char* bytes, size_t size) {
+  header = nullptr;
+  if (size < sizeof(Header)) return false;
+  const Header* h = (const Header*)bytes;
+
+  auto fits = [&](uint32_t offset, uint64_t count, size_t stride) {
+    return offset % 4 == 0 && offset + count * stride <= size;
+  };
+
+  if (std::memcmp(h->magic, MAGIC, 4) != 0 || h->version != VERSION || h->size != size ||
+      h->rows == 0 || h->cols == 0 ||
+      !fits(h->tiles_offset, (uint64_t)h->rows * h->cols, 1) ||
+      !fits(h->balls_offset, h->ball_count, sizeof(Ball)) ||
+      !fits(h->coins_offset, h->coin_count, sizeof(Vector2)) ||
+      !fits(h->checkpoints_offset, h->checkpoint_count, sizeof(Rectangle))) {
+    return false;
+  }
+
+  header = h;
+  tiles = bytes + h->tiles_offset;
+  balls = (const Ball*)(bytes + h->balls_offset);
+  coins = (const Vector2*)(bytes + h->coins_offset);
+  checkpoints = (const Rectangle*)(bytes + h->checkpoints_offset);
+  return true;
+}
+
+void LevelFile::close() {
+  file.close();
+  header = nullptr;
+  tiles = nullptr;
+  balls = nullptr;
+  coins = nullptr;
+  checkpoints = nullptr;
+}
+
+void LevelFile::read(Level& level) const {
+  level.start = header->start;
+  level.finish = header->finish;
+
+  level.map.assign(header->rows, std::vector<char>(header->cols));
+  for (uint32_t r = 0; r < header->rows; r++) {
+    std::memcpy(level.map[r].data(), tiles + r * header->cols, header->cols);
+  }
+
+  level.obstacles.clear();
+  level.obstacles.reserve(header->ball_count);
+  for (uint32_t i = 0; i < header->ball_count; i++) {
+    Circle circle;
+    if (unpack(balls[i], circle)) level.obstacles.push_back(std::move(circle));
+  }
+
+  level.coins.clear();
+  level.coins.reserve(header->coin_count);
+  for (uint32_t i = 0; i < header->coin_count; i++) level.coins.emplace_back(coins[i]);
+
+  level.checkpoints.assign(checkpoints, checkpoints + header->checkpoint_count);
+}
+
+LevelFile::Ball LevelFile::pack(const Circle& c) {
+  Ball b = {};
+  b.pos = c.pos;
+  b.radius = c.radius;
+  b.kind = c.move->kind;
+  switch (c.move->kind) {
+    case Move::Linear: {
+      Linear* linear = (Linear*)c.move.get();
+      b.speed = linear->speed;
+      b.dir = linear->dir;
+      b.min = linear->bounds.min;
+      b.max = linear->bounds.max;
+    } break;
+    case Move::Chaser: {
+      b.speed = ((Chaser*)c.move.get())->speed;
+    } break;
+  }
+  return b;
+}
+
+// False for balls of an unknown kind, which are skipped.
+bool LevelFile::unpack(const Ball& b, Circle& circle) {
+  std::shared_ptr<Move> move;
+  switch (b.kind) {
+    case Move::Linear: {
+      move = std::make_shared<Linear>(b.dir, b.speed, Bounds{b.min, b.max});
+    } break;
+    case Move::Chaser: {
+      move = std::make_shared<Chaser>(b.speed, b.pos);
+    } break;
+    default: return false;
+  }
+  circle = {.pos = b.pos, .prev = b.pos, .radius = b.radius, .move = move};
+  return true;
+}
+
+std::vector<char> LevelFile::encode(const Level& level) {
+  Header h = {};
+  std::memcpy(h.magic, MAGIC, 4);
+  h.version = VERSION;
+  h.rows = level.map.size();
+  h.cols = h.rows > 0 ? level.map[0].size() : 0;
+  h.start = level.start;
+  h.finish = level.finish;
+  h.ball_count = level.obstacles.size();
+  h.coin_count = level.coins.size();
+  h.checkpoint_count = level.checkpoints.size();
+  h.tiles_offset = align(sizeof(Header));
+  h.balls_offset = h.tiles_offset + align(h.rows * h.cols);
+  h.coins_offset = h.balls_offset + h.ball_count * sizeof(Ball);
+  h.checkpoints_offset = h.coins_offset + h.coin_count * sizeof(Vector2);
+  h.size = h.checkpoints_offset + h.checkpoint_count * sizeof(Rectangle);
+
+  std::vector<char> out(h.size, 0);
+  std::memcpy(out.data(), &h, sizeof(h));
+
+  for (uint32_t r = 0; r < h.rows; r++) {
+    std::memcpy(out.data() + h.tiles_offset + r * h.cols, level.map[r].data(), h.cols);
+  }
+
+  Ball* balls = (Ball*)(out.data() + h.balls_offset);
+  for (uint32_t i = 0; i < h.ball_count; i++) balls[i] = pack(level.obstacles[i]);
+
+  Vector2* coins = (Vector2*)(out.data() + h.coins_offset);
+  for (uint32_t i = 0; i < h.coin_count; i++) coins[i] = level.coins[i].pos;
+
+  std::memcpy(
+    out.data() + h.checkpoints_offset,
+    level.checkpoints.data(),
+    h.checkpoint_count * sizeof(Rectangle)
+  );
+
+  return out;
+}
+
+bool LevelFile::write(const Level& level, const std::filesystem::path& path) {
+  std::vector<char> out = encode(level);
+
+  // Write next to the target and rename so a running game never maps a half written file.
+  std::filesystem::path tmp = path;
+  tmp += ".tmp";
+  std::ofstream f(tmp, std::ios::binary);
+  if (!f.is_open()) return false;
+  f.write(out.data(), out.size());
+  f.close();
+  if (!f) return false;
+
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  return !ec;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "level.h"
+#include "mapped.h"
+
+// Binary level format, a cache of data.json + map.txt that is memory mapped
+// and read in place. All fields are 4 byte aligned little endian, positions
+// are stored in pixels so nothing has to be converted on load.
+//
+//   Header | tiles (rows * cols chars, padded to 4) | Ball[] | Vector2[] coins | Rectangle[] checkpoints
+class LevelFile {
+ public:
+  static constexpr const char* NAME = "level.bin";
+  static constexpr char MAGIC[4] = {'T', 'L', 'V', 'L'};
+  static constexpr uint32_t VERSION = 1;
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t size;  // of the whole file
+    uint32_t rows;
+    uint32_t cols;
+    Rectangle start;
+    Rectangle finish;
+    uint32_t ball_count;
+    uint32_t coin_count;
+    uint32_t checkpoint_count;
+    uint32_t tiles_offset;
+    uint32_t balls_offset;
+    uint32_t coins_offset;
+    uint32_t checkpoints_offset;
+  };
+
+  struct Ball {
+    Vector2 pos;
+    float radius;
+    uint32_t kind;  // Move::Kind
+    float speed;
+    Vector2 dir;    // Linear only
+    Vector2 min;    // Linear only
+    Vector2 max;    // Linear only
+  };
+
+  const Header* header = nullptr;
+  const char* tiles = nullptr;
+  const Ball* balls = nullptr;
+  const Vector2* coins = nullptr;
+  const Rectangle* checkpoints = nullptr;
+
+  LevelFile() = default;
+
+  bool open(const std::filesystem::path& path);
+  bool view(const char* bytes, size_t size);  // borrowed, e.g. an entry of a LevelPack
+  void close();
+  void read(Level& level) const;
+
+  static Ball pack(const Circle& circle);
+  static bool unpack(const Ball& ball, Circle& circle);
+  static std::vector<char> encode(const Level& level);
+  static bool write(const Level& level, const std::filesystem::path& path);
+
+ private:
+  MappedFile file;
+};
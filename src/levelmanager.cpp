@@ -0,0 +1,107 @@
+#include "levelmanager.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+LevelManager::LevelManager(std::vector<std::filesystem::path> dirs)
+    : levels(dirs.size()), dirs(std::move(dirs)) {}
+
+LevelManager::LevelManager(const std::filesystem::path& pack_path) {
+  packed = pack.open(pack_path);
+  if (!packed) throw std::runtime_error(pack_path.string() + ": missing or invalid level pack");
+  levels.resize(pack.count());
+}
+
+LevelManager::LevelManager(const unsigned char* pack_bytes, size_t size) {
+  packed = pack.view((const char*)pack_bytes, size);
+  if (!packed) throw std::runtime_error("embedded level pack is invalid");
+  levels.resize(pack.count());
+}
+
+size_t LevelManager::count() const {
+  return levels.size();
+}
+
+std::filesystem::path LevelManager::dir(size_t i) const {
+  return dirs[i];
+}
+
+// Hot reload of an edited level. Levels that aren't built yet pick the edit
+// up when they are, a broken edit keeps the previous version running.
+Level* LevelManager::reload(size_t i, int changes) {
+  if (packed || i >= levels.size()) return nullptr;
+  if (pending.valid() && pending_index == i) collect();
+  if (!levels[i]) return nullptr;
+
+  try {
+    levels[i]->reload(dir(i), changes);
+  } catch (const std::exception& e) {
+    fprintf(stderr, "reload: %s\n", e.what());
+    return nullptr;
+  }
+  return levels[i].get();
+}
+
+std::unique_ptr<Level> LevelManager::build(size_t i) const {
+  if (!packed) return std::make_unique<Level>(dir(i));
+
+  LevelFile file;
+  if (!pack.entry(i, file)) {
+    throw std::runtime_error(pack.name(i) + ": corrupt level pack entry");
+  }
+  return std::make_unique<Level>(file, pack.name(i));
+}
+
+// Wait for the outstanding prefetch and store its level. A failed prefetch is
+// dropped here, the level is built again when it's loaded and fails there.
+void LevelManager::collect() {
+  if (!pending.valid()) return;
+  try {
+    auto level = pending.get();
+    if (!levels[pending_index]) levels[pending_index] = std::move(level);
+  } catch (const std::exception&) {
+  }
+}
+
+void LevelManager::prefetch(size_t i) {
+  if (i >= levels.size() || levels[i]) return;
+  if (pending.valid() && pending_index == i) return;
+
+  collect();
+  pending_index = i;
+  pending = std::async(std::launch::async, [this, i] { return build(i); });
+}
+
+// Null when the level fails to load, it's built again on the next attempt.
+Level* LevelManager::load(size_t i) {
+  try {
+    if (!levels[i] && pending.valid() && pending_index == i) {
+      levels[i] = pending.get();
+    }
+    if (!levels[i]) levels[i] = build(i);
+  } catch (const std::exception& e) {
+    fprintf(stderr, "load: %s\n", e.what());
+    return nullptr;
+  }
+  return levels[i].get();
+}
+
+Level* LevelManager::get(size_t level_num) {
+  if (level_num == 0 || level_num > levels.size()) return nullptr;
+  index = level_num - 1;
+  return current();
+}
+
+Level* LevelManager::current() {
+  Level* level = load(index);
+  prefetch(index + 1);
+  return level;
+}
+
+Level* LevelManager::next() {
+  index++;
+  if (index < levels.size()) return current();
+  return nullptr;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "level.h"
+#include "levelpack.h"
+
+// Levels are constructed on first access, either from level directories or
+// from the entries of a level pack, on disk or embedded. While a level is
+// played the next one is built on a worker thread, so advancing is a pointer
+// swap.
+class LevelManager {
+ public:
+  std::vector<std::unique_ptr<Level>> levels;
+  std::vector<std::filesystem::path> dirs;
+  size_t index = 0;
+  LevelPack pack;
+  bool packed = false;
+
+  LevelManager(std::vector<std::filesystem::path> dirs);
+  LevelManager(const std::filesystem::path& pack_path);
+  LevelManager(const unsigned char* pack_bytes, size_t size);
+
+  size_t count() const;
+  std::filesystem::path dir(size_t i) const;
+  Level* reload(size_t i, int changes);  // the reloaded level, null if it wasn't
+  // All of these are null past the last level or when the level fails to load.
+  Level* get(size_t level_num);
+  Level* current();
+  Level* next();
+
+ private:
+  std::future<std::unique_ptr<Level>> pending;
+  size_t pending_index = 0;
+
+  std::unique_ptr<Level> build(size_t i) const;
+  void collect();
+  void prefetch(size_t i);
+  Level* load(size_t i);
+};
@@ -0,0 +1,108 @@
+#include "levelpack.h"
+
+#include <cstring>
+#include <fstream>
+
+bool LevelPack::open(const std::filesystem::path& path) {
+  if (!file.open(path)) return false;
+  if (view(file.data, file.size)) return true;
+  file.close();
+  return false;
+}
+
+bool LevelPack::view(const char* bytes, size_t size) {
+  header = nullptr;
+  entries = nullptr;
+  data = nullptr;
+  this->size = 0;
+
+  const Header* h = (const Header*)bytes;
+  if (size < sizeof(Header) || std::memcmp(h->magic, MAGIC, 4) != 0 || h->version != VERSION ||
+      h->toc_offset % 4 != 0 || h->toc_offset + (uint64_t)h->count * sizeof(Entry) > size) {
+    return false;
+  }
+
+  header = h;
+  entries = (const Entry*)(bytes + h->toc_offset);
+  data = bytes;
+  this->size = size;
+  return true;
+}
+
+size_t LevelPack::count() const {
+  return header ? header->count : 0;
+}
+
+std::string LevelPack::name(size_t i) const {
+  return std::string(entries[i].name, strnlen(entries[i].name, sizeof(entries[i].name)));
+}
+
+bool LevelPack::entry(size_t i, LevelFile& level) const {
+  if (i >= count()) return false;
+  const Entry& e = entries[i];
+  if ((uint64_t)e.offset + e.size > size) return false;
+  const char* bytes = data + e.offset;
+  if (checksum(bytes, e.size) != e.checksum) return false;
+  return level.view(bytes, e.size);
+}
+
+uint32_t LevelPack::checksum(const char* bytes, size_t size) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= (unsigned char)bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+std::vector<char> LevelPack::encode(const std::vector<std::filesystem::path>& dirs) {
+  std::vector<char> out(sizeof(Header), 0);
+  std::vector<Entry> toc;
+
+  for (const auto& dir : dirs) {
+    std::vector<char> bytes = LevelFile::encode(Level(dir));
+    out.resize((out.size() + 7) & ~size_t(7), 0);
+
+    Entry e = {};
+    std::string name = dir.filename().string();
+    if (name.empty()) name = dir.parent_path().filename().string();
+    std::strncpy(e.name, name.c_str(), sizeof(e.name) - 1);
+    e.offset = out.size();
+    e.size = bytes.size();
+    e.checksum = checksum(bytes.data(), bytes.size());
+    toc.push_back(e);
+
+    out.insert(out.end(), bytes.begin(), bytes.end());
+  }
+
+  out.resize((out.size() + 7) & ~size_t(7), 0);
+  Header h = {};
+  std::memcpy(h.magic, MAGIC, 4);
+  h.version = VERSION;
+  h.count = toc.size();
+  h.toc_offset = out.size();
+  std::memcpy(out.data(), &h, sizeof(h));
+
+  const char* table = (const char*)toc.data();
+  out.insert(out.end(), table, table + toc.size() * sizeof(Entry));
+  return out;
+}
+
+bool LevelPack::write(
+  const std::vector<std::filesystem::path>& dirs,
+  const std::filesystem::path& path
+) {
+  std::vector<char> out = encode(dirs);
+
+  std::filesystem::path tmp = path;
+  tmp += ".tmp";
+  std::ofstream f(tmp, std::ios::binary);
+  if (!f.is_open()) return false;
+  f.write(out.data(), out.size());
+  f.close();
+  if (!f) return false;
+
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  return !ec;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "levelfile.h"
+#include "mapped.h"
+
+// Single file archive of binary levels. The table of contents sits at the end,
+// entries are 8 byte aligned `LevelFile` images and are only checksummed when
+// they are first loaded. A pack can also be compiled into the binary, see
+// `EMBED_LEVELS`.
+//
+//   Header | entry 0 | entry 1 | ... | Entry[count]
+class LevelPack {
+ public:
+  static constexpr const char* NAME = "levels.pack";
+  static constexpr char MAGIC[4] = {'T', 'L', 'P', 'K'};
+  static constexpr uint32_t VERSION = 1;
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t toc_offset;
+  };
+
+  struct Entry {
+    char name[32];
+    uint32_t offset;
+    uint32_t size;
+    uint32_t checksum;  // FNV-1a of the entry bytes
+    uint32_t reserved;
+  };
+
+  const Header* header = nullptr;
+  const Entry* entries = nullptr;
+
+  LevelPack() = default;
+
+  bool open(const std::filesystem::path& path);
+  bool view(const char* bytes, size_t size);  // borrowed, must outlive the pack
+  size_t count() const;
+  std::string name(size_t i) const;
+  bool entry(size_t i, LevelFile& file) const;
+
+  static uint32_t checksum(const char* bytes, size_t size);
+  static std::vector<char> encode(const std::vector<std::filesystem::path>& dirs);
+  static bool write(const std::vector<std::filesystem::path>& dirs, const std::filesystem::path& path);
+
+ private:
+  MappedFile file;
+  const char* data = nullptr;
+  size_t size = 0;
+};
+
+#ifdef EMBED_LEVELS
+// Pack image generated at build time by `levelconv embed`.
+extern const unsigned char EMBEDDED_LEVELS[];
+extern const size_t EMBEDDED_LEVELS_SIZE;
+#endif
@@ -1,24 +1,40 @@
+#include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
 #include <cfloat>
 #include <cstdio>
+#include <deque>
+#include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <ostream>
 #define RAYGUI_IMPLEMENTATION
 
 #include <raylib.h>
 
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "camera.h"
 #include "conf.h"
+#include "catalog.h"
 #include "json.h"
 #include "level.h"
+#include "levelmanager.h"
+#include "mapcodec.h"
 #include "player.h"
 #include "raygui.h"
+#include "redraw.h"
 #include "serde.h"
+#include "tilecache.h"
+#include "triplebuffer.h"
+#include "watcher.h"
+#include "world.h"
 
-using conf::win, conf::SIZE, conf::ROWS, conf::COLS, nlohmann::json;
+using conf::win, conf::SIZE, conf::ROWS, conf::COLS, conf::TICK, nlohmann::json;
 
 class AssetManager {
  public:
@@ -58,15 +74,15 @@ class LevelBuilder {
   int active = 0;
   int minx{}, miny{}, maxx{}, maxy{};
   float timer;
+  RenderQueue queue;
+  TileCache tile_cache;
+  TileRuns runs;
+  uint64_t revision = 1;  // bumped on every edit of the map or markers
 
   void save() {
     std::ofstream f("test.txt");
     if (!f.is_open()) return;
-    for (auto& row : map) {
-      std::string line(row.data(), row.size());
-      line.push_back('\n');
-      f << line;
-    }
+    f << format_map_plain(map);
 
     std::ofstream d("data.json");
     if (!d.is_open()) return;
@@ -121,7 +137,18 @@ class LevelBuilder {
 
  public:
   LevelBuilder(Player* player)
-      : map(conf::ROWS, std::vector<char>(conf::COLS, '.')), player(player) {}
+      : map(conf::ROWS, std::vector<char>(conf::COLS, '.')), player(player) {
+    runs.rows.resize(ROWS);
+  }
+
+  // Frees the cached texture, has to happen before the window closes.
+  void release() {
+    tile_cache.release();
+  }
+
+  bool animating() const {
+    return is_playing;
+  }
 
   void update() {
     float dt = GetFrameTime();
@@ -137,14 +164,9 @@ class LevelBuilder {
     }
   }
 
+  // Half tile lines on top of the game's tile grid.
   void draw_grid() {
-    int HALF_TILE = SIZE / 2;
-    for (int y = 0; y < win.y / HALF_TILE; y++) {
-      DrawLine(0, y * HALF_TILE, win.x, y * HALF_TILE, Fade(conf::GRID_COLOR, 0.5));
-    }
-    for (int x = 0; x < win.x / HALF_TILE; x++) {
-      DrawLine(x * HALF_TILE, 0, x * HALF_TILE, win.y, Fade(conf::GRID_COLOR, 0.5));
-    }
+    queue.grid(Layer::Background, {0, 0, win.x, win.y}, SIZE / 2, Fade(conf::GRID_COLOR, 0.5));
   }
 
   void draw_ball_bounds(const Circle& circle) {
@@ -152,35 +174,37 @@ class LevelBuilder {
       case Move::Linear: {
         Linear* linear = (Linear*)circle.move.get();
         const Bounds& bounds = linear->bounds;
-        DrawLine(bounds.min.x, bounds.min.y, bounds.max.x, bounds.max.y, RED);
+        // Under the balls, so the lines don't split their sprite run.
+        queue.line(Layer::Markers, bounds.min, bounds.max, RED);
       } break;
+      case Move::Chaser: break;
     }
   }
 
+  void draw_static(RenderQueue& queue) {
+    runs.draw(queue);
+    queue.rect(Layer::Markers, start, conf::CHECKPOINT_COLOR);
+    queue.rect(Layer::Markers, finish, conf::CHECKPOINT_COLOR);
+    for (const auto& check : checkpoints) queue.rect(Layer::Markers, check, conf::CHECKPOINT_COLOR);
+  }
+
   void draw_level() {
-    for (size_t y = 0; y < map.size(); y++) {
-      for (size_t x = 0; x < map[0].size(); x++) {
-        if (map[y][x] == '#') {
-          DrawRectangle(
-            x * SIZE,
-            y * SIZE,
-            SIZE,
-            SIZE,
-            (x + y) % 2 == 0 ? conf::TILE_COLORS.first : conf::TILE_COLORS.second
-          );
-        }
-      }
+    // While painting the map changes every frame, re-rendering the cache would cost more.
+    bool painting = current_shape == Floor &&
+                    (IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonDown(MOUSE_BUTTON_RIGHT));
+    if (painting) {
+      draw_static(queue);
+    } else {
+      tile_cache.update(revision, COLS * SIZE, ROWS * SIZE, [this](auto& q) { draw_static(q); });
+      tile_cache.draw(queue);
     }
 
-    DrawRectangleRec(start, conf::CHECKPOINT_COLOR);
-    DrawRectangleRec(finish, conf::CHECKPOINT_COLOR);
-
     for (const auto& obs : is_playing ? live_obstacles : obstacles) {
-      obs.draw();
+      obs.draw(queue);
       draw_ball_bounds(obs);
     }
 
-    for (const auto& coin : coins) coin.draw();
+    for (const auto& coin : coins) coin.draw(queue);
   }
 
   void draw_controls() {
@@ -213,8 +237,11 @@ class LevelBuilder {
   }
 
   void draw() {
+    queue.clear();
     draw_grid();
     draw_level();
+    RaylibBackend backend;
+    queue.flush(backend);
     draw_controls();
 
     if (is_playing) {
@@ -232,8 +259,14 @@ class LevelBuilder {
 
     switch (current_shape) {
       case Floor: {
-        if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) map[r][c] = '#';
-        else if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) map[r][c] = '.';
+        char tile = map[r][c];
+        if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) tile = '#';
+        else if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) tile = '.';
+        if (tile != map[r][c]) {
+          map[r][c] = tile;
+          runs.update_row(r, map[r].data(), COLS);
+          revision++;
+        }
 
         DrawRectangle(
           c * SIZE,
@@ -252,6 +285,7 @@ class LevelBuilder {
           };
           Circle circle = {
             .pos = snap,
+            .prev = snap,
             .move = std::make_shared<Linear>(vec2(1, 0), 200, bounds),
           };
           obstacles.push_back(circle);
@@ -286,6 +320,7 @@ class LevelBuilder {
       case Start: {
         if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
           start = {(float)c * SIZE, (float)r * SIZE, SIZE * 2, SIZE * 2};
+          revision++;
         }
         DrawRectangle(c * SIZE, r * SIZE, SIZE * 2, SIZE * 2, conf::CHECKPOINT_COLOR);
       } break;
@@ -293,6 +328,7 @@ class LevelBuilder {
       case Finish: {
         if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
           finish = {(float)c * SIZE, (float)r * SIZE, SIZE * 2, SIZE * 2};
+          revision++;
         }
         DrawRectangle(c * SIZE, r * SIZE, SIZE * 2, SIZE * 2, conf::CHECKPOINT_COLOR);
       } break;
@@ -300,6 +336,21 @@ class LevelBuilder {
   }
 };
 
+// Levels compiled into the binary when built with EMBED=1, otherwise the pack
+// next to the binary or the level directories found by the catalog.
+static LevelManager load_levels(LevelCatalog& catalog) {
+#ifdef EMBED_LEVELS
+  (void)catalog;
+  return LevelManager(EMBEDDED_LEVELS, EMBEDDED_LEVELS_SIZE);
+#else
+  if (std::filesystem::exists(LevelPack::NAME)) {
+    return LevelManager(std::filesystem::path(LevelPack::NAME));
+  }
+  catalog.scan("levels");
+  return LevelManager(catalog.dirs());
+#endif
+}
+
 class Game {
  private:
   enum Screen {
@@ -307,20 +358,81 @@ class Game {
     Play,
     Done,
     Builder,
+    Roam,
   };
 
+  // What drawing needs from one simulation tick.
+  struct Snapshot {
+    std::chrono::steady_clock::time_point time;
+    Screen screen;  // where the simulation is headed, stays Play or Roam until it's finished
+    Player player;
+    int deaths = 0;
+    int pickups = 0;  // coins collected, like `deaths` a running total
+    std::vector<EntityState> entities;
+    std::vector<std::shared_ptr<const World::Chunk>> chunks;  // Roam only
+  };
+
+  // Owned by the sim thread while it runs.
   Player player;
   int deaths = 0;
+  int pickups = 0;
 
   Screen screen = Start;
+  std::string typed;  // level number entered on the start screen
+  std::string error;  // why the last level didn't start, shown on the start screen
+  LevelCatalog catalog;
   LevelManager level_manager;
+  LevelWatcher watcher;
   Level* level = nullptr;
+  std::unique_ptr<World> world;  // streamed from world.bin when present
 
   AssetManager asset_manager;
   LevelBuilder builder;
+  RenderQueue queue;
+  RaylibBackend backend;
+  TileCache tile_cache;
+  FollowCamera camera;
+
+  // Play and Roam simulate on their own thread at a fixed tick. Meanwhile the
+  // main thread only reads the published snapshots and the parts of the level
+  // or world that don't change during play, and anything else stops the sim first.
+  std::thread sim;
+  std::atomic<bool> simulating = false;
+  // Arrow key changes, stamped when the main thread saw them. raylib's key
+  // state belongs to the thread that polls it, so the sim thread can't read it.
+  // Each tick applies the changes made up to its own time instead, so ticks
+  // that catch up after a stall replay the input in the order it happened.
+  struct Steer {
+    std::chrono::steady_clock::time_point time;
+    vec2 dir;
+  };
+  std::mutex steer_mutex;
+  std::deque<Steer> steering;  // oldest first
+  vec2 last_steer;             // main thread only, the last direction queued
+  // Totals of the last fetched snapshot, its sounds play on the main thread.
+  int heard_deaths = 0;
+  int heard_pickups = 0;
+  // What the last frame showed, grown by a margin. Snapshots only carry the
+  // entities in it, set to everything until the first frame is drawn.
+  std::mutex seen_mutex;
+  Rectangle seen;
+  Screen simulated = Start;   // the screen being simulated
+  Screen sim_screen = Start;  // set by the sim thread when play ends
+  TripleBuffer<Snapshot> frames;
+
+  RedrawScheduler redraw;
+  Screen drawn = Start;  // screen of the last drawn frame
 
  public:
-  Game() : level_manager(2), builder(&player) {
+  Game() : level_manager(load_levels(catalog)), builder(&player) {
+    if (!level_manager.packed) {
+      for (size_t i = 0; i < level_manager.count(); i++) watcher.add(level_manager.dir(i), i);
+    }
+#ifndef EMBED_LEVELS
+    // Embedded builds stay self contained and don't look for files next to the binary.
+    if (std::filesystem::exists(World::NAME)) world = std::make_unique<World>(World::NAME);
+#endif
+
     InitWindow(win.x, win.y, "The Impossible Game");
     InitAudioDevice();
     asset_manager.load();
@@ -330,32 +442,57 @@ class Game {
   void run() {
     while (!WindowShouldClose()) {
       update();
-      draw();
+      // Play, Roam and a running builder change every frame, the rest only on input.
+      if (screen == Play || screen == Roam || (screen == Builder && builder.animating())) {
+        redraw.request();
+      }
+      if (screen != drawn) redraw.request();
+
+      if (redraw.due()) {
+        drawn = screen;
+        draw();
+      } else {
+        redraw.wait();
+      }
     }
   }
 
   void update_start() {
     if (IsKeyPressed(KEY_ENTER)) {
-      level = level_manager.current();
+      size_t num = typed.empty() ? level_manager.index + 1 : std::stoul(typed);
+      level = level_manager.get(num);
+      if (!level) {
+        bool exists = num >= 1 && num <= level_manager.count();
+        error = "LEVEL " + std::to_string(num) + (exists ? " FAILED TO LOAD" : " DOESN'T EXIST");
+      }
+      typed.clear();
+    }
+
+    if (IsKeyPressed(KEY_W) && world) {
+      world->reset();
+      world->set_player(player.pos, player.size);
+      player.place();
+      screen = Roam;
+      start_sim();
+      return;
     }
 
-    char key = GetKeyPressed();
-    if (isdigit(key)) {
-      int level_num = key - '0';
-      printf("level = %d\n", level_num);
-      level = level_manager.get(level_num);
+    if (IsKeyPressed(KEY_BACKSPACE) && !typed.empty()) typed.pop_back();
+    for (int key = GetCharPressed(); key > 0; key = GetCharPressed()) {
+      if (isdigit(key) && typed.size() < 6) typed.push_back(key);
     }
 
     if (level != nullptr) {
+      error.clear();
       level->set_player(player.pos, player.size);
+      player.place();
       screen = Play;
+      start_sim();
     }
   }
 
-  void update_play() {
-    float dt = GetFrameTime();
-
-    level->update(dt);
+  void update_play(float dt) {
+    level->update(dt, player.pos + player.size / 2);
     player.update(dt, level);
 
     if (player.dead) return;
@@ -363,38 +500,47 @@ class Game {
     Rectangle rect = player.rect();
     for (auto& obs : level->obstacles) {
       if (CheckCollisionCircleRec(obs.pos, obs.radius, rect)) {
-        PlaySound(asset_manager.sounds["hit"]);
         deaths += 1;
         player.dead = true;
         player.fade.reset();
         return;
       }
+    }
 
-      for (size_t i = 0; i < level->coins.size(); i++) {
-        auto& coin = level->coins[i];
-        if (CheckCollisionCircleRec(coin.pos, coin.radius, rect)) {
-          PlaySound(asset_manager.sounds["collect"]);
-          level->coins.erase(level->coins.begin() + i);
-        }
+    int mask = SpatialIndex::Coins | SpatialIndex::Checkpoints;
+    level->index.query(rect, mask, [&](const SpatialIndex::Item& item) {
+      if (item.kind == SpatialIndex::Checkpoints) {
+        level->current_checkpoint = item.index;
+        return;
       }
-
-      for (int i = 0; i < (int)level->checkpoints.size(); i++) {
-        if (CheckCollisionRecs(rect, level->checkpoints[i])) {
-          level->current_checkpoint = i;
-        }
+      auto& coin = level->coins[item.index];
+      if (!coin.collected && CheckCollisionCircleRec(coin.pos, coin.radius, rect)) {
+        pickups += 1;
+        coin.collected = true;
+        level->coins_left--;
       }
+    });
 
-      if (level->coins.size() == 0 && CheckCollisionRecs(rect, level->finish)) {
-        screen = Done;
-      }
+    if (level->coins_left == 0 && CheckCollisionRecs(rect, level->finish)) {
+      sim_screen = Done;
     }
   }
 
   void update_done() {
     if (IsKeyPressed(KEY_ENTER)) {
-      if (!(level = level_manager.next())) return;
+      if (!(level = level_manager.next())) {
+        // Past the last level there is nowhere to go, a level that failed to load
+        // goes back to the start screen so it can be fixed and retried.
+        if (level_manager.index < level_manager.count()) {
+          error = "LEVEL " + std::to_string(level_manager.index + 1) + " FAILED TO LOAD";
+          screen = Start;
+        }
+        return;
+      }
       level->set_player(player.pos, player.size);
+      player.place();
       screen = Play;
+      start_sim();
     }
   }
 
@@ -402,68 +548,295 @@ class Game {
     builder.update();
   }
 
+  // Same rules as a level, but only the chunks around the player exist.
+  void update_roam(float dt) {
+    world->focus(player.pos);
+    world->update(dt);
+    player.update(dt, world.get());
+
+    if (player.dead) return;
+
+    Rectangle rect = player.rect();
+    world->each_chunk([&](World::Chunk& chunk) {
+      for (auto& obs : chunk.obstacles) {
+        if (!player.dead && CheckCollisionCircleRec(obs.pos, obs.radius, rect)) {
+          deaths += 1;
+          player.dead = true;
+          player.fade.reset();
+        }
+      }
+      for (size_t i = 0; i < chunk.coins.size(); i++) {
+        auto& coin = chunk.coins[i];
+        if (!coin.collected && CheckCollisionCircleRec(coin.pos, coin.radius, rect)) {
+          pickups += 1;
+          world->collect(chunk, i);
+        }
+      }
+      for (auto& check : chunk.checkpoints) {
+        if (CheckCollisionRecs(check, rect)) world->respawn = check;
+      }
+    });
+
+    if (!player.dead && world->coins_left == 0 && CheckCollisionRecs(rect, world->finish)) {
+      sim_screen = Start;
+    }
+  }
+
+  // Runs on the sim thread, called with the state captured after each tick.
+  void capture(Snapshot& snap) {
+    snap.time = std::chrono::steady_clock::now();
+    snap.screen = sim_screen;
+    snap.player = player;
+    snap.deaths = deaths;
+    snap.pickups = pickups;
+    snap.entities.clear();
+    snap.chunks.clear();
+    Rectangle area;
+    {
+      std::lock_guard lock(seen_mutex);
+      area = seen;
+    }
+    if (simulated == Play) level->capture(snap.entities, area);
+    else world->capture(snap.entities, snap.chunks, area);
+  }
+
+  // Steps the screen's simulation in fixed ticks until it finishes or is
+  // stopped. Falling further behind than a long frame drops the time instead
+  // of catching up.
+  void simulate() {
+    using clock = std::chrono::steady_clock;
+    auto tick = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(TICK));
+    auto lag = std::chrono::duration<float>(conf::MAX_FRAME_TIME);
+    auto next = clock::now();
+
+    while (simulating && sim_screen == simulated) {
+      {
+        std::lock_guard lock(steer_mutex);
+        while (!steering.empty() && steering.front().time <= next) {
+          player.dir = steering.front().dir;
+          steering.pop_front();
+        }
+      }
+      if (simulated == Play) update_play(TICK);
+      else update_roam(TICK);
+      capture(frames.back());
+      frames.publish();
+
+      next += tick;
+      if (clock::now() - next > lag) next = clock::now();
+      std::this_thread::sleep_until(next);
+    }
+  }
+
+  void start_sim() {
+    simulated = screen;
+    sim_screen = screen;
+    last_steer = player.dir = Player::input();
+    steering.clear();
+    seen = {-FLT_MAX / 2, -FLT_MAX / 2, FLT_MAX, FLT_MAX};
+    frames.fetch();  // a frame left over from the last run
+    capture(frames.front());
+    heard_deaths = frames.front().deaths;
+    heard_pickups = frames.front().pickups;
+    simulating = true;
+    sim = std::thread(&Game::simulate, this);
+  }
+
+  // Snapshots can be skipped, so sounds follow the running totals rather than single events.
+  void play_sounds(const Snapshot& snap) {
+    if (snap.deaths > heard_deaths) PlaySound(asset_manager.sounds["hit"]);
+    if (snap.pickups > heard_pickups) PlaySound(asset_manager.sounds["collect"]);
+    heard_deaths = snap.deaths;
+    heard_pickups = snap.pickups;
+  }
+
+  void stop_sim() {
+    simulating = false;
+    if (sim.joinable()) sim.join();
+  }
+
   void update() {
     // UpdateMusicStream(asset_manager.music);
+    bool playing = screen == Play || screen == Roam;
+    if (playing) {
+      if (frames.fetch()) play_sounds(frames.front());
+      if (frames.front().screen != screen) {
+        stop_sim();
+        screen = frames.front().screen;
+        playing = false;
+      }
+    }
+
+    auto events = watcher.poll();
+    if (!events.empty()) {
+      // Reloading replaces the level under the simulation.
+      if (playing) stop_sim();
+      for (auto& e : events) {
+        // A built level already parsed the edit, only levels that aren't are read again.
+        if (Level* level = level_manager.reload(e.id, e.changes)) catalog.update(e.id, *level);
+        else catalog.refresh(e.id);
+      }
+      if (playing) start_sim();
+      redraw.request();
+    }
+
     switch (screen) {
       case Start: update_start(); break;
-      case Play: update_play(); break;
       case Done: update_done(); break;
       case Builder: update_builder(); break;
+      case Play:
+      case Roam: {
+        vec2 dir = Player::input();
+        if (dir != last_steer) {
+          std::lock_guard lock(steer_mutex);
+          steering.push_back({std::chrono::steady_clock::now(), dir});
+          last_steer = dir;
+        }
+        camera.zoom_by(GetMouseWheelMove());
+      } break;
     }
   }
 
-  void draw_grid(float spacing) {
-    for (int x = 0; x < COLS; x++) {
-      DrawLine(x * spacing, 0, x * spacing, win.y, conf::GRID_COLOR);
-    }
-    for (int y = 0; y < ROWS; y++) {
-      DrawLine(0, y * spacing, win.x, y * spacing, conf::GRID_COLOR);
-    }
+  // Behind the menus in screen space, under the level in world space while playing.
+  void draw_grid(Layer layer, Rectangle area) {
+    queue.grid(layer, area, SIZE, conf::GRID_COLOR);
+  }
+
+  // The camera moves a little between the tick that captures and the frame that draws.
+  void publish_view(Rectangle view) {
+    float margin = SIZE * 2;
+    std::lock_guard lock(seen_mutex);
+    seen = {
+      view.x - margin,
+      view.y - margin,
+      view.width + margin * 2,
+      view.height + margin * 2,
+    };
   }
 
   void draw_start() {
     const char* text = "START SCREEN";
     float font_size = 40;
     float text_width = MeasureText(text, font_size);
-    DrawText(text, win.x / 2 - text_width / 2, win.y / 2 - font_size / 2, font_size, LIGHTGRAY);
+    queue.text(
+      Layer::Overlay,
+      text,
+      {win.x / 2 - text_width / 2, win.y / 2 - font_size / 2},
+      font_size,
+      LIGHTGRAY
+    );
+
+    std::string num = typed.empty() ? std::to_string(level_manager.index + 1) : typed;
+    std::string prompt = "LEVEL " + num + " / " + std::to_string(level_manager.count());
+    float prompt_size = font_size / 2;
+    text_width = MeasureText(prompt.c_str(), prompt_size);
+    queue.text(
+      Layer::Overlay,
+      prompt,
+      {win.x / 2 - text_width / 2, win.y / 2 + font_size},
+      prompt_size,
+      GRAY
+    );
+
+    if (!error.empty()) {
+      text_width = MeasureText(error.c_str(), prompt_size);
+      queue.text(
+        Layer::Overlay,
+        error,
+        {win.x / 2 - text_width / 2, win.y / 2 + font_size * 2},
+        prompt_size,
+        RED
+      );
+    }
+  }
+
+  void draw_start_controls() {
     if (GuiButton({24, 24, 120, 30}, "Builder")) {
       screen = Builder;
     }
   }
 
-  void draw_header() {
-    DrawRectangle(0, 0, win.x, SIZE, BLACK);
+  void draw_header(int deaths) {
+    queue.rect(Layer::Overlay, {0, 0, win.x, SIZE}, BLACK);
     int font_size = 20;
-    std::string text = "LEVEL: " + std::to_string(1);
-    DrawText(
-      text.c_str(),
-      win.x / 2 - (float)MeasureText(text.c_str(), font_size) / 2,
-      SIZE / 2,
+    std::string text = "LEVEL: " + std::to_string(level_manager.index + 1);
+    queue.text(
+      Layer::Overlay,
+      text,
+      {win.x / 2 - (float)MeasureText(text.c_str(), font_size) / 2, SIZE / 2},
       font_size,
       RAYWHITE
     );
     text = "DEATHS: " + std::to_string(deaths);
-    DrawText(
-      text.c_str(),
-      win.x - MeasureText(text.c_str(), font_size) - SIZE,
-      SIZE / 2 - font_size / 2,
+    queue.text(
+      Layer::Overlay,
+      text,
+      {win.x - MeasureText(text.c_str(), font_size) - SIZE, (float)(SIZE / 2 - font_size / 2)},
       font_size,
       RAYWHITE
     );
   }
 
+  // How far drawing is from the snapshot's tick towards the next one.
+  float blend() {
+    auto since = std::chrono::steady_clock::now() - frames.front().time;
+    return std::min(std::chrono::duration<float>(since).count() / TICK, 1.0f);
+  }
+
+  void draw_entities(const Snapshot& snap, Rectangle view, float alpha) {
+    for (const auto& entity : snap.entities) {
+      if (CheckCollisionCircleRec(entity.pos, entity.radius, view)) entity.draw(queue, alpha);
+    }
+  }
+
   void draw_play() {
-    draw_grid(SIZE);
-    level->draw();
-    player.draw();
-    draw_header();
+    const Snapshot& snap = frames.front();
+    float alpha = blend();
+    // Follows where the player is drawn, not where the last tick left it.
+    camera.follow(snap.player.at(alpha) + snap.player.size / 2, level->bounds());
+    queue.camera = camera.camera;
+    Rectangle view = camera.view();
+    publish_view(view);
+    draw_grid(Layer::Tiles, view);
+    // A level that fits the window is cached whole, a bigger one draws only what's in view.
+    if (level->rows <= ROWS && level->cols <= COLS) {
+      tile_cache.update(level->revision, level->cols * SIZE, level->rows * SIZE, [&](auto& q) {
+        level->draw_static(q, level->bounds());
+      });
+      tile_cache.draw(queue);
+    } else {
+      level->draw_static(queue, view);
+    }
+    draw_entities(snap, view, alpha);
+    snap.player.draw(queue, alpha);
+    draw_header(snap.deaths);
+  }
+
+  void draw_roam() {
+    const Snapshot& snap = frames.front();
+    float alpha = blend();
+    camera.follow(snap.player.at(alpha) + snap.player.size / 2, world->bounds());
+    queue.camera = camera.camera;
+    Rectangle view = camera.view();
+    publish_view(view);
+    draw_grid(Layer::Tiles, view);
+    world->draw_static(queue, view, snap.chunks);
+    draw_entities(snap, view, alpha);
+    snap.player.draw(queue, alpha);
+    draw_header(snap.deaths);
   }
 
   void draw_done() {
     const char* text = "LEVEL COMPLETE";
     float font_size = 40;
     float text_width = MeasureText(text, font_size);
-    DrawText(text, win.x / 2 - text_width / 2, win.y / 2 - font_size / 2, font_size, LIGHTGRAY);
+    queue.text(
+      Layer::Overlay,
+      text,
+      {win.x / 2 - text_width / 2, win.y / 2 - font_size / 2},
+      font_size,
+      LIGHTGRAY
+    );
   }
 
   void draw_builder() {
@@ -471,20 +844,34 @@ class Game {
   }
 
   void draw() {
-    BeginDrawing();
-    ClearBackground(conf::BG_COLOR);
-    draw_grid(SIZE);
+    queue.clear();
+    if (screen != Play && screen != Roam) draw_grid(Layer::Background, {0, 0, win.x, win.y});
     switch (screen) {
       case Start: draw_start(); break;
       case Play: draw_play(); break;
       case Done: draw_done(); break;
+      case Builder: break;
+      case Roam: draw_roam(); break;
+    }
+
+    BeginDrawing();
+    ClearBackground(conf::BG_COLOR);
+    queue.flush(backend);
+
+    // raygui draws while it handles input, so widgets go on top of the recorded frame.
+    switch (screen) {
+      case Start: draw_start_controls(); break;
       case Builder: draw_builder(); break;
+      default: break;
     }
     DrawFPS(0, 0);
     EndDrawing();
   }
 
   ~Game() {
+    stop_sim();
+    tile_cache.release();
+    builder.release();
     CloseAudioDevice();
     CloseWindow();
   }
@@ -0,0 +1,219 @@
+#include "mapcodec.h"
+
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+
+static const char* RLE_TAG = "rle ";
+
+static bool is_tile(char c) {
+  return c == '#' || c == '.';
+}
+
+// Splits `text` into lines without copying, tolerating CRLF and a missing final newline.
+static std::vector<std::string_view> lines(const char* text, size_t size) {
+  std::vector<std::string_view> out;
+  std::string_view rest(text, size);
+  while (!rest.empty()) {
+    size_t end = rest.find('\n');
+    std::string_view line = rest.substr(0, end);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    out.push_back(line);
+    if (end == std::string_view::npos) break;
+    rest.remove_prefix(end + 1);
+  }
+  while (!out.empty() && out.back().empty()) out.pop_back();
+  return out;
+}
+
+static bool read_int(std::string_view& s, size_t& value) {
+  auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  if (ec != std::errc() || end == s.data()) return false;
+  s.remove_prefix(end - s.data());
+  return true;
+}
+
+[[noreturn]] static void fail(const std::string& name, size_t line, const std::string& what) {
+  throw std::runtime_error(name + ":" + std::to_string(line) + ": " + what);
+}
+
+static void check_width(const std::string& name, size_t line, size_t width, size_t cols) {
+  if (width != cols) {
+    fail(name, line, "row is " + std::to_string(width) + " tiles wide, expected " +
+                       std::to_string(cols));
+  }
+}
+
+// `line` is 1 based, only used for errors.
+static void read_plain_row(
+  std::string_view row,
+  size_t cols,
+  std::vector<char>& out,
+  const std::string& name,
+  size_t line
+) {
+  check_width(name, line, row.size(), cols);
+  for (char c : row) {
+    if (!is_tile(c)) fail(name, line, std::string("unknown tile '") + c + "'");
+  }
+  out.assign(row.begin(), row.end());
+}
+
+static void read_rle_header(
+  std::string_view header,
+  size_t& cols,
+  size_t& rows,
+  const std::string& name
+) {
+  header.remove_prefix(4);
+  bool ok = read_int(header, cols) && header.starts_with(' ');
+  if (ok) header.remove_prefix(1);
+  if (!ok || !read_int(header, rows) || !header.empty() || cols == 0 || rows == 0) {
+    fail(name, 1, "expected 'rle <cols> <rows>'");
+  }
+}
+
+// Any row but '=', which the caller handles by keeping the previous one.
+static void read_rle_row(
+  std::string_view row,
+  size_t cols,
+  std::vector<char>& out,
+  const std::string& name,
+  size_t line
+) {
+  out.clear();
+  out.reserve(cols);
+  while (!row.empty()) {
+    size_t run = 1;
+    if (row[0] >= '0' && row[0] <= '9' && (!read_int(row, run) || run == 0)) {
+      fail(name, line, "bad run length");
+    }
+    if (row.empty() || !is_tile(row[0])) fail(name, line, "expected a tile after the run length");
+    if (out.size() + run > cols) fail(name, line, "row is wider than " + std::to_string(cols));
+    out.insert(out.end(), run, row[0]);
+    row.remove_prefix(1);
+  }
+  check_width(name, line, out.size(), cols);
+}
+
+std::vector<std::vector<char>> parse_map(const char* text, size_t size, const std::string& name) {
+  std::vector<std::string_view> rows = lines(text, size);
+  if (rows.empty()) throw std::runtime_error(name + ": map is empty");
+
+  std::vector<std::vector<char>> map;
+  if (!rows[0].starts_with(RLE_TAG)) {
+    size_t cols = rows[0].size();
+    if (cols == 0) fail(name, 1, "map has no columns");
+    map.resize(rows.size());
+    for (size_t y = 0; y < rows.size(); y++) read_plain_row(rows[y], cols, map[y], name, y + 1);
+    return map;
+  }
+
+  size_t cols = 0, count = 0;
+  read_rle_header(rows[0], cols, count, name);
+  if (rows.size() - 1 != count) {
+    fail(name, rows.size(), "map has " + std::to_string(rows.size() - 1) + " rows, expected " +
+                              std::to_string(count));
+  }
+
+  map.reserve(count);
+  for (size_t y = 1; y < rows.size(); y++) {
+    if (rows[y] == "=") {
+      if (map.empty()) fail(name, y + 1, "first row can't repeat");
+      map.push_back(map.back());
+      continue;
+    }
+    read_rle_row(rows[y], cols, map.emplace_back(), name, y + 1);
+  }
+  return map;
+}
+
+MapReader::MapReader(const std::filesystem::path& path) : file(path), name(path.string()) {
+  if (!file.is_open()) throw std::runtime_error(name + ": missing or empty");
+
+  std::string header;
+  if (!read_line(header)) throw std::runtime_error(name + ": map is empty");
+  rle = header.starts_with(RLE_TAG);
+  if (rle) {
+    read_rle_header(header, cols, rows, name);
+    return;
+  }
+
+  // Plain maps don't say how many rows they have, count them without keeping any.
+  cols = header.size();
+  if (cols == 0) fail(name, 1, "map has no columns");
+  rows = 1;
+  for (size_t count = 1; read_line(header);) {
+    count++;
+    if (!header.empty()) rows = count;
+  }
+  file.clear();
+  file.seekg(0);
+  line = 0;
+}
+
+bool MapReader::read_line(std::string& text) {
+  if (!std::getline(file, text)) return false;
+  if (!text.empty() && text.back() == '\r') text.pop_back();
+  line++;
+  return true;
+}
+
+bool MapReader::next() {
+  if (done == rows) {
+    // Only trailing empty lines may follow, like `parse_map` allows.
+    std::string rest;
+    while (rle && read_line(rest)) {
+      if (!rest.empty()) {
+        fail(name, line, "map has more than " + std::to_string(rows) + " rows");
+      }
+    }
+    return false;
+  }
+
+  std::string text;
+  if (!read_line(text)) {
+    fail(name, line, "map has " + std::to_string(done) + " rows, expected " +
+                       std::to_string(rows));
+  }
+  if (!rle) {
+    read_plain_row(text, cols, row, name, line);
+  } else if (text == "=") {
+    if (done == 0) fail(name, line, "first row can't repeat");
+  } else {
+    read_rle_row(text, cols, row, name, line);
+  }
+  done++;
+  return true;
+}
+
+std::string format_map_plain(const std::vector<std::vector<char>>& map) {
+  std::string out;
+  out.reserve(map.size() * (map.empty() ? 1 : map[0].size() + 1));
+  for (const auto& row : map) {
+    out.append(row.begin(), row.end());
+    out.push_back('\n');
+  }
+  return out;
+}
+
+std::string format_map_rle(const std::vector<std::vector<char>>& map) {
+  size_t cols = map.empty() ? 0 : map[0].size();
+  std::string out = RLE_TAG + std::to_string(cols) + " " + std::to_string(map.size()) + "\n";
+  for (size_t y = 0; y < map.size(); y++) {
+    const auto& row = map[y];
+    if (y > 0 && row == map[y - 1]) {
+      out += "=\n";
+      continue;
+    }
+    for (size_t x = 0; x < row.size();) {
+      size_t run = 1;
+      while (x + run < row.size() && row[x + run] == row[x]) run++;
+      if (run > 1) out += std::to_string(run);
+      out.push_back(row[x]);
+      x += run;
+    }
+    out.push_back('\n');
+  }
+  return out;
+}
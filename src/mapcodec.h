@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// map.txt comes in two encodings. Plain has one char per tile, '#' floor and
+// '.' wall, one line per row. Run length encoded maps start with a header and
+// store every row as runs of `[count]tile`, a count of 1 may be left out and a
+// row that repeats the previous one is written as '='.
+//
+//   rle 400 18
+//   400.
+//   .398#.
+//   =
+//
+// Both are validated strictly: every row must be exactly as wide as the map.
+std::vector<std::vector<char>> parse_map(const char* text, size_t size, const std::string& name);
+
+// Reads map.txt a row at a time with the same checks as `parse_map`, for maps
+// too big to hold whole. A plain map is read twice, once to count its rows.
+class MapReader {
+ public:
+  size_t rows = 0;
+  size_t cols = 0;
+  std::vector<char> row;  // the last row `next` read
+
+  MapReader(const std::filesystem::path& path);
+
+  // False once every row was read, throws on malformed rows like `parse_map`.
+  bool next();
+
+ private:
+  std::ifstream file;
+  std::string name;
+  bool rle = false;
+  size_t line = 0;  // of the file, for errors
+  size_t done = 0;  // rows read so far
+
+  bool read_line(std::string& text);
+};
+
+// Maps are written plain unless run length encoding is asked for.
+std::string format_map_plain(const std::vector<std::vector<char>>& map);
+std::string format_map_rle(const std::vector<std::vector<char>>& map);
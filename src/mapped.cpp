@@ -0,0 +1,41 @@
+#include "mapped.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+bool MappedFile::open(const std::filesystem::path& path) {
+  close();
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+
+  void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED) return false;
+
+  data = (const char*)ptr;
+  size = st.st_size;
+  return true;
+}
+
+void MappedFile::close() {
+  if (data) munmap((void*)data, size);
+  data = nullptr;
+  size = 0;
+}
+
+bool MappedFile::is_open() const {
+  return data != nullptr;
+}
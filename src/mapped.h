@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile {
+ public:
+  const char* data = nullptr;
+  size_t size = 0;
+
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  bool open(const std::filesystem::path& path);
+  void close();
+  bool is_open() const;
+};
@@ -4,7 +4,9 @@
 
 using conf::SIZE;
 
-bool sweep_aabb(vec2& pos, vec2 size, vec2 delta, Level* level) {
+// `blocked(r0, r1, c0, c1)` tells whether any tile of the inclusive range is a wall.
+template <typename Blocked>
+static void sweep(vec2& pos, vec2 size, vec2 delta, Blocked&& blocked) {
   if (delta.x != 0) {
     float nx = pos.x + delta.x;
     float x_edge = delta.x > 0 ? nx + size.x - 1 : nx;
@@ -13,14 +15,11 @@ bool sweep_aabb(vec2& pos, vec2 size, vec2 delta, Level* level) {
     int row_start = pos.y / SIZE;
     int row_end = (pos.y + size.y - 1) / SIZE;
 
-    for (int r = row_start; r <= row_end; r++) {
-      if (level->get(r, c) == '.') {
-        // Snap to edge of tile
-        if (delta.x > 0) pos.x = c * SIZE - size.x;
-        else pos.x = (c + 1) * SIZE;
-        delta.x = 0;
-        break;
-      }
+    if (blocked(row_start, row_end, c, c)) {
+      // Snap to edge of tile
+      if (delta.x > 0) pos.x = c * SIZE - size.x;
+      else pos.x = (c + 1) * SIZE;
+      delta.x = 0;
     }
 
     pos.x += delta.x;
@@ -34,29 +33,73 @@ bool sweep_aabb(vec2& pos, vec2 size, vec2 delta, Level* level) {
     int col_start = pos.x / SIZE;
     int col_end = (pos.x + size.x - 1) / SIZE;
 
-    for (int c = col_start; c <= col_end; c++) {
-      if (level->get(r, c) == '.') {
-        if (delta.y > 0) pos.y = r * SIZE - size.y;
-        else pos.y = (r + 1) * SIZE;
-        delta.y = 0;
-        break;
-      }
+    if (blocked(r, r, col_start, col_end)) {
+      if (delta.y > 0) pos.y = r * SIZE - size.y;
+      else pos.y = (r + 1) * SIZE;
+      delta.y = 0;
     }
 
     pos.y += delta.y;
   }
+}
+
+// Levels look the edge up in their merged wall boxes, one index query instead
+// of a tile read per row or column the player spans.
+bool sweep_aabb(vec2& pos, vec2 size, vec2 delta, Level* level) {
+  sweep(pos, size, delta, [level](int r0, int r1, int c0, int c1) {
+    if (r0 < 0 || c0 < 0 || r1 >= level->rows || c1 >= level->cols) return true;
+    Rectangle edge = {
+      (float)c0 * SIZE,
+      (float)r0 * SIZE,
+      (float)(c1 - c0 + 1) * SIZE,
+      (float)(r1 - r0 + 1) * SIZE,
+    };
+    bool hit = false;
+    level->index.query(edge, SpatialIndex::Walls, [&](const SpatialIndex::Item&) { hit = true; });
+    return hit;
+  });
+  return true;
+}
 
+bool sweep_aabb(vec2& pos, vec2 size, vec2 delta, World* world) {
+  sweep(pos, size, delta, [world](int r0, int r1, int c0, int c1) {
+    for (int r = r0; r <= r1; r++) {
+      for (int c = c0; c <= c1; c++) {
+        if (world->get(r, c) == '.') return true;
+      }
+    }
+    return false;
+  });
   return true;
 }
 
+// Shared by levels and streamed worlds, both respawn through `set_player`.
+template <typename Map>
+static void step(Player& player, float dt, Map* map) {
+  player.prev = player.pos;
+  if (player.dead) {
+    player.fade.update(dt);
+    if (player.fade.done) {
+      player.dead = false;
+      map->set_player(player.pos, player.size);
+      player.place();
+    }
+    return;
+  }
+
+  player.move(dt, map);
+}
+
 Rectangle Player::rect() const {
   return {pos.x, pos.y, size.x, size.y};
 }
 
-void Player::input() {
-  dir.x = IsKeyDown(KEY_RIGHT) - IsKeyDown(KEY_LEFT);
-  dir.y = IsKeyDown(KEY_DOWN) - IsKeyDown(KEY_UP);
-  dir = dir.norm();
+vec2 Player::input() {
+  vec2 dir = {
+    (float)(IsKeyDown(KEY_RIGHT) - IsKeyDown(KEY_LEFT)),
+    (float)(IsKeyDown(KEY_DOWN) - IsKeyDown(KEY_UP)),
+  };
+  return dir.norm();
 }
 
 void Player::move(float dt, Level* level) {
@@ -64,22 +107,33 @@ void Player::move(float dt, Level* level) {
   sweep_aabb(pos, size, delta, level);
 }
 
+void Player::move(float dt, World* world) {
+  // Chunks still loading read as wall, the sweep would push the player out of them.
+  if (!world->ready(rect())) return;
+  vec2 delta = dir * speed * dt;
+  sweep_aabb(pos, size, delta, world);
+}
+
 void Player::update(float dt, Level* level) {
-  if (dead) {
-    fade.update(dt);
-    if (fade.done) {
-      dead = false;
-      level->set_player(pos, size);
-    }
-    return;
-  }
+  step(*this, dt, level);
+}
+
+void Player::update(float dt, World* world) {
+  step(*this, dt, world);
+}
+
+void Player::place() {
+  prev = pos;
+}
 
-  input();
-  move(dt, level);
+vec2 Player::at(float alpha) const {
+  return prev + (pos - prev) * alpha;
 }
 
-void Player::draw() const {
-  float alpha = dead ? fade.current_frame() : 1.0f;
-  DrawRectangleV(pos, size, Fade(ORANGE, alpha));
-  DrawRectangleLinesEx({pos.x, pos.y, size.x, size.y}, 2, BLACK);
+void Player::draw(RenderQueue& queue, float alpha) const {
+  vec2 p = at(alpha);
+  Rectangle r = {p.x, p.y, size.x, size.y};
+  float opacity = dead ? fade.current_frame() : 1.0f;
+  queue.rect(Layer::Actors, r, Fade(ORANGE, opacity));
+  queue.rect_lines(Layer::Actors, r, 2, BLACK);
 }
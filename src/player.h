@@ -4,12 +4,14 @@
 
 #include "animation.h"
 #include "level.h"
+#include "world.h"
 #include "vec2.h"
 
 class Player {
  public:
   vec2 pos;
-  vec2 dir;
+  vec2 prev;  // `pos` before the last update, for interpolated drawing
+  vec2 dir;  // set from `input` before every update
   vec2 size = {25, 25};
   float speed = 200;
   float dead = false;
@@ -17,9 +19,13 @@ class Player {
 
   Player() = default;
 
-  void input();
+  static vec2 input();  // arrow keys, read on the thread owning the window
   void move(float dt, Level* level);
+  void move(float dt, World* world);
   void update(float dt, Level* level);
-  void draw() const;
+  void update(float dt, World* world);
+  void place();  // after `pos` jumped, so drawing doesn't blend across the jump
+  vec2 at(float alpha) const;
+  void draw(RenderQueue& queue, float alpha = 1) const;
   Rectangle rect() const;
 };
@@ -0,0 +1,80 @@
+#include "raycast.h"
+
+#include <cfloat>
+#include <cmath>
+
+#include "conf.h"
+
+using conf::SIZE;
+
+template <typename Grid>
+static RayHit cast(const Grid& grid, vec2 origin, vec2 dir, float max_dist) {
+  RayHit hit;
+  dir = dir.norm();
+
+  int col = std::floor(origin.x / SIZE);
+  int row = std::floor(origin.y / SIZE);
+  int step_col = dir.x > 0 ? 1 : -1;
+  int step_row = dir.y > 0 ? 1 : -1;
+
+  // Distance along the ray between two vertical / horizontal grid lines and
+  // to the first one of each.
+  float delta_x = dir.x != 0 ? std::fabs(SIZE / dir.x) : FLT_MAX;
+  float delta_y = dir.y != 0 ? std::fabs(SIZE / dir.y) : FLT_MAX;
+  float next_x = dir.x > 0   ? ((col + 1) * SIZE - origin.x) / dir.x
+                 : dir.x < 0 ? (col * SIZE - origin.x) / dir.x
+                             : FLT_MAX;
+  float next_y = dir.y > 0   ? ((row + 1) * SIZE - origin.y) / dir.y
+                 : dir.y < 0 ? (row * SIZE - origin.y) / dir.y
+                             : FLT_MAX;
+
+  float t = 0;
+  vec2 normal;
+  while (true) {
+    if (grid.get(row, col) == '.') {
+      hit.hit = true;
+      hit.dist = t;
+      hit.point = origin + dir * t;
+      hit.normal = normal;
+      hit.row = row;
+      hit.col = col;
+      return hit;
+    }
+
+    if (next_x < next_y) {
+      t = next_x;
+      next_x += delta_x;
+      col += step_col;
+      normal = {(float)-step_col, 0};
+    } else {
+      t = next_y;
+      next_y += delta_y;
+      row += step_row;
+      normal = {0, (float)-step_row};
+    }
+
+    if (t >= max_dist || (dir.x == 0 && dir.y == 0)) break;
+  }
+
+  hit.dist = max_dist;
+  hit.point = origin + dir * max_dist;
+  return hit;
+}
+
+RayHit raycast(const Level& level, vec2 origin, vec2 dir, float max_dist) {
+  return level.with_grid([&](const auto& grid) { return cast(grid, origin, dir, max_dist); });
+}
+
+void raycast(const Level& level, const std::vector<GridRay>& rays, std::vector<RayHit>& hits) {
+  hits.resize(rays.size());
+  level.with_grid([&](const auto& grid) {
+    for (size_t i = 0; i < rays.size(); i++) {
+      hits[i] = cast(grid, rays[i].origin, rays[i].dir, rays[i].max_dist);
+    }
+  });
+}
+
+bool line_of_sight(const Level& level, vec2 from, vec2 to) {
+  vec2 delta = to - from;
+  return !raycast(level, from, delta, delta.length()).hit;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include "level.h"
+#include "vec2.h"
+
+struct GridRay {
+  vec2 origin;
+  vec2 dir;
+  float max_dist;
+};
+
+struct RayHit {
+  bool hit = false;
+  float dist = 0;
+  vec2 point;
+  vec2 normal;  // face of the tile that was entered, zero when starting inside a wall
+  int row = -1;
+  int col = -1;
+};
+
+// Amanatides-Woo grid traversal, walls are the '.' tiles (including everything
+// outside the map), so every ray terminates at the map border at the latest.
+RayHit raycast(const Level& level, vec2 origin, vec2 dir, float max_dist);
+void raycast(const Level& level, const std::vector<GridRay>& rays, std::vector<RayHit>& hits);
+bool line_of_sight(const Level& level, vec2 from, vec2 to);
@@ -0,0 +1,34 @@
+#include "redraw.h"
+
+#include <raylib.h>
+
+#include <initializer_list>
+
+void RedrawScheduler::request() {
+  requested = true;
+}
+
+// Doesn't consume the char queue, text input still reaches the screens.
+bool RedrawScheduler::input() {
+  if (GetKeyPressed() != 0 || GetMouseWheelMove() != 0) return true;
+  Vector2 delta = GetMouseDelta();
+  if (delta.x != 0 || delta.y != 0) return true;
+  for (int button : {MOUSE_BUTTON_LEFT, MOUSE_BUTTON_RIGHT, MOUSE_BUTTON_MIDDLE}) {
+    if (IsMouseButtonDown(button) || IsMouseButtonReleased(button)) return true;
+  }
+  return false;
+}
+
+bool RedrawScheduler::due() {
+  double now = GetTime();
+  if (!requested && !input() && now - last_frame < IDLE_INTERVAL) return false;
+  requested = false;
+  last_frame = now;
+  return true;
+}
+
+// EndDrawing polls input for drawn frames, skipped ones have to do it themselves.
+void RedrawScheduler::wait() {
+  WaitTime(POLL_INTERVAL);
+  PollInputEvents();
+}
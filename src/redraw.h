@@ -0,0 +1,22 @@
+#pragma once
+
+// Decides which frames of a mostly static screen are worth drawing. A frame
+// is drawn on input, when something asked for it and at a low idle rate
+// otherwise; in between the loop sleeps instead of redrawing the same image.
+class RedrawScheduler {
+ public:
+  static constexpr double IDLE_INTERVAL = 0.5;       // longest time between two frames
+  static constexpr double POLL_INTERVAL = 1.0 / 60;  // input checks while nothing is drawn
+
+  RedrawScheduler() = default;
+
+  void request();  // draw the next frame, e.g. after a screen change or a reload
+  bool due();      // once per loop after updating, whether to draw now
+  void wait();     // in place of drawing, sleeps and gathers input
+
+ private:
+  bool requested = true;
+  double last_frame = 0;
+
+  static bool input();
+};
@@ -0,0 +1,357 @@
+#include "render.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "instancing.h"
+
+static bool same_color(Color a, Color b) {
+  return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static bool in_world(Layer layer) {
+  return layer != Layer::Background && layer != Layer::Overlay;
+}
+
+// Whether `b` continues `a` to the right or below, so both draw as one rectangle.
+// Checkers qualify too, their pattern is anchored to the map and not the rectangle.
+static bool extend(DrawCommand& a, const DrawCommand& b) {
+  if (a.kind != b.kind || a.layer != b.layer || !same_color(a.color, b.color)) return false;
+  if (a.kind == DrawCommand::Checker) {
+    if (!same_color(a.alt, b.alt) || a.cell != b.cell) return false;
+  } else if (a.kind != DrawCommand::Rect) {
+    return false;
+  }
+  Rectangle& r = a.rect;
+  const Rectangle& s = b.rect;
+  if (s.y == r.y && s.height == r.height && s.x == r.x + r.width) {
+    r.width += s.width;
+    return true;
+  }
+  if (s.x == r.x && s.width == r.width && s.y == r.y + r.height) {
+    r.height += s.height;
+    return true;
+  }
+  return false;
+}
+
+// 2x2 mask with the odd cells opaque, repeated over a checker so each texel covers one cell.
+static Texture2D checker_mask() {
+  static Texture2D mask = {};
+  if (mask.id == 0) {
+    Image image = GenImageChecked(2, 2, 1, 1, BLANK, WHITE);
+    mask = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureWrap(mask, TEXTURE_WRAP_REPEAT);
+  }
+  return mask;
+}
+
+// One grid cell with its top and left line set, repeated over a grid so the
+// whole grid is one quad. One per spacing, there are only a few.
+static Texture2D grid_mask(int spacing) {
+  static std::vector<std::pair<int, Texture2D>> masks;
+  for (const auto& [s, mask] : masks) {
+    if (s == spacing) return mask;
+  }
+
+  std::vector<Color> pixels(spacing * spacing, BLANK);
+  for (int i = 0; i < spacing; i++) {
+    pixels[i] = WHITE;
+    pixels[i * spacing] = WHITE;
+  }
+  Image image = {pixels.data(), spacing, spacing, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+  Texture2D mask = LoadTextureFromImage(image);
+  SetTextureWrap(mask, TEXTURE_WRAP_REPEAT);
+  masks.push_back({spacing, mask});
+  return mask;
+}
+
+// Outlined circles, the outline is as wide relative to the radius as the
+// one pixel outline of the original primitives at the entity's default size.
+struct SpriteSpec {
+  Color fill;
+  float outline;
+};
+
+static const SpriteSpec SPRITES[(int)Sprite::COUNT] = {
+  {BLUE, 1 / 10.0f},   // Ball
+  {YELLOW, 1 / 7.5f},  // Coin
+};
+
+static const int SPRITE_SIZE = 32;  // cell per sprite, side by side in the atlas
+// The circle in a cell is inset by a pixel, quads are this much bigger than the radius.
+static const float SPRITE_SCALE = (SPRITE_SIZE / 2.0f) / (SPRITE_SIZE / 2.0f - 1);
+
+// Rasterized on the CPU with antialiased edges, so building it never starts a
+// render pass in the middle of a frame.
+static Texture2D sprite_atlas() {
+  static Texture2D atlas = {};
+  if (atlas.id != 0) return atlas;
+
+  int width = SPRITE_SIZE * (int)Sprite::COUNT;
+  std::vector<Color> pixels(width * SPRITE_SIZE, BLANK);
+  float radius = SPRITE_SIZE / 2.0f - 1;
+  for (int i = 0; i < (int)Sprite::COUNT; i++) {
+    const SpriteSpec& spec = SPRITES[i];
+    float inner = radius * (1 - spec.outline);
+    for (int y = 0; y < SPRITE_SIZE; y++) {
+      for (int x = 0; x < SPRITE_SIZE; x++) {
+        float dx = x + 0.5f - SPRITE_SIZE / 2.0f, dy = y + 0.5f - SPRITE_SIZE / 2.0f;
+        float d = std::sqrt(dx * dx + dy * dy);
+        float fill = std::clamp(inner - d + 0.5f, 0.0f, 1.0f);
+        float alpha = std::clamp(radius - d + 0.5f, 0.0f, 1.0f);
+        Color& c = pixels[y * width + i * SPRITE_SIZE + x];
+        c.r = spec.fill.r * fill;
+        c.g = spec.fill.g * fill;
+        c.b = spec.fill.b * fill;
+        c.a = 255 * alpha;
+      }
+    }
+  }
+
+  Image image = {pixels.data(), width, SPRITE_SIZE, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+  atlas = LoadTextureFromImage(image);
+  SetTextureFilter(atlas, TEXTURE_FILTER_BILINEAR);
+  return atlas;
+}
+
+void RaylibBackend::camera(const Camera2D* camera) {
+  if (camera) BeginMode2D(*camera);
+  else EndMode2D();
+}
+
+void RaylibBackend::submit(const DrawCommand& cmd, const char* text) {
+  const Rectangle& r = cmd.rect;
+  switch (cmd.kind) {
+    case DrawCommand::Rect: DrawRectangleRec(r, cmd.color); break;
+    case DrawCommand::RectLines: DrawRectangleLinesEx(r, cmd.thick, cmd.color); break;
+    case DrawCommand::Circle: DrawCircleV({r.x, r.y}, r.width, cmd.color); break;
+    case DrawCommand::CircleLines: DrawCircleLinesV({r.x, r.y}, r.width, cmd.color); break;
+    case DrawCommand::Line: DrawLineV({r.x, r.y}, {r.width, r.height}, cmd.color); break;
+    case DrawCommand::Text: DrawText(text, r.x, r.y, cmd.font_size, cmd.color); break;
+    case DrawCommand::Texture: {
+      DrawTexturePro(cmd.texture, cmd.source, r, {0, 0}, 0, cmd.color);
+    } break;
+    case DrawCommand::Checker: {
+      DrawRectangleRec(r, cmd.color);
+      Rectangle cells = {r.x / cmd.cell, r.y / cmd.cell, r.width / cmd.cell, r.height / cmd.cell};
+      DrawTexturePro(checker_mask(), cells, r, {0, 0}, 0, cmd.alt);
+    } break;
+    case DrawCommand::Grid: {
+      int spacing = std::max((int)cmd.cell, 1);
+      // Sampled at the rectangle's own position, so the lines stay on multiples of the spacing.
+      DrawTexturePro(grid_mask(spacing), r, r, {0, 0}, 0, cmd.color);
+    } break;
+    case DrawCommand::Sprite: {
+      float half = r.width * SPRITE_SCALE;
+      Rectangle source = {(float)(int)cmd.sprite * SPRITE_SIZE, 0, SPRITE_SIZE, SPRITE_SIZE};
+      Rectangle dest = {r.x - half, r.y - half, half * 2, half * 2};
+      DrawTexturePro(sprite_atlas(), source, dest, {0, 0}, 0, WHITE);
+    } break;
+    default: break;
+  }
+}
+
+void RenderBackend::sprites(const DrawCommand* cmds, size_t count) {
+  for (size_t i = 0; i < count; i++) submit(cmds[i], nullptr);
+}
+
+// One instanced call per sprite type for the whole run, balls below coins.
+void RaylibBackend::sprites(const DrawCommand* cmds, size_t count) {
+  static SpriteInstancer instancer;
+  static std::vector<SpriteInstancer::Instance> instances;
+  if (!instancer.ready()) {
+    RenderBackend::sprites(cmds, count);
+    return;
+  }
+
+  size_t first[(int)Sprite::COUNT + 1] = {};
+  for (size_t i = 0; i < count; i++) first[(int)cmds[i].sprite + 1]++;
+  for (int s = 0; s < (int)Sprite::COUNT; s++) first[s + 1] += first[s];
+
+  size_t next[(int)Sprite::COUNT];
+  std::copy(first, first + (int)Sprite::COUNT, next);
+  instances.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    const DrawCommand& cmd = cmds[i];
+    float radius = cmd.rect.width * SPRITE_SCALE;
+    instances[next[(int)cmd.sprite]++] = {cmd.rect.x, cmd.rect.y, radius, cmd.color};
+  }
+  instancer.upload(instances.data(), count);
+
+  Texture2D atlas = sprite_atlas();
+  for (int s = 0; s < (int)Sprite::COUNT; s++) {
+    Rectangle source = {(float)s * SPRITE_SIZE, 0, SPRITE_SIZE, SPRITE_SIZE};
+    instancer.draw(atlas, source, first[s], first[s + 1] - first[s]);
+  }
+}
+
+void NullBackend::camera(const Camera2D*) {
+  camera_switches++;
+}
+
+void NullBackend::submit(const DrawCommand& cmd, const char*) {
+  calls[cmd.kind]++;
+}
+
+void NullBackend::sprites(const DrawCommand* cmds, size_t count) {
+  RenderBackend::sprites(cmds, count);
+  sprite_batches++;
+}
+
+size_t NullBackend::total() const {
+  size_t n = 0;
+  for (size_t c : calls) n += c;
+  return n;
+}
+
+void RenderQueue::clear() {
+  commands.clear();
+  texts.clear();
+  camera.reset();
+  stats = {};
+}
+
+void RenderQueue::rect(Layer layer, Rectangle rect, Color color) {
+  commands.push_back({.layer = layer, .kind = DrawCommand::Rect, .color = color, .rect = rect});
+}
+
+void RenderQueue::rect_lines(Layer layer, Rectangle rect, float thick, Color color) {
+  commands.push_back({
+    .layer = layer,
+    .kind = DrawCommand::RectLines,
+    .color = color,
+    .rect = rect,
+    .thick = thick,
+  });
+}
+
+void RenderQueue::circle(Layer layer, vec2 center, float radius, Color color) {
+  commands.push_back({
+    .layer = layer,
+    .kind = DrawCommand::Circle,
+    .color = color,
+    .rect = {center.x, center.y, radius, radius},
+  });
+}
+
+void RenderQueue::circle_lines(Layer layer, vec2 center, float radius, Color color) {
+  commands.push_back({
+    .layer = layer,
+    .kind = DrawCommand::CircleLines,
+    .color = color,
+    .rect = {center.x, center.y, radius, radius},
+  });
+}
+
+void RenderQueue::line(Layer layer, vec2 from, vec2 to, Color color) {
+  commands.push_back({
+    .layer = layer,
+    .kind = DrawCommand::Line,
+    .color = color,
+    .rect = {from.x, from.y, to.x, to.y},
+  });
+}
+
+void RenderQueue::text(Layer layer, const std::string& text, vec2 pos, int font_size, Color color) {
+  commands.push_back({
+    .layer = layer,
+    .kind = DrawCommand::Text,
+    .color = color,
+    .rect = {pos.x, pos.y, 0, 0},
+    .font_size = font_size,
+    .text = (uint32_t)texts.size(),
+  });
+  texts.append(text);
+  texts.push_back('\0');
+}
+
+void RenderQueue::texture(
+  Layer layer,
+  Texture2D texture,
+  Rectangle source,
+  Rectangle dest,
+  Color tint
+) {
+  commands.push_back({
+    .layer = layer,
+    .kind = DrawCommand::Texture,
+    .color = tint,
+    .rect = dest,
+    .texture = texture,
+    .source = source,
+  });
+}
+
+void RenderQueue::checker(Layer layer, Rectangle rect, float cell, Color even, Color odd) {
+  commands.push_back({
+    .layer = layer,
+    .kind = DrawCommand::Checker,
+    .color = even,
+    .rect = rect,
+    .alt = odd,
+    .cell = cell,
+  });
+}
+
+void RenderQueue::sprite(Layer layer, Sprite sprite, vec2 center, float radius) {
+  commands.push_back({
+    .layer = layer,
+    .kind = DrawCommand::Sprite,
+    .color = WHITE,
+    .rect = {center.x, center.y, radius, radius},
+    .sprite = sprite,
+  });
+}
+
+// Lines every `spacing` pixels from the top left corner of `rect`, drawn as one quad.
+void RenderQueue::grid(Layer layer, Rectangle rect, float spacing, Color color) {
+  commands.push_back({
+    .layer = layer,
+    .kind = DrawCommand::Grid,
+    .color = color,
+    .rect = rect,
+    .cell = spacing,
+  });
+}
+
+void RenderQueue::flush(RenderBackend& backend) {
+  stats.recorded = commands.size();
+  auto by_layer = [](const DrawCommand& a, const DrawCommand& b) { return a.layer < b.layer; };
+  std::stable_sort(commands.begin(), commands.end(), by_layer);
+
+  size_t merged = 0;
+  for (size_t i = 0; i < commands.size(); i++) {
+    if (merged > 0 && extend(commands[merged - 1], commands[i])) continue;
+    commands[merged++] = commands[i];
+  }
+  commands.resize(merged);
+
+  bool world = false;
+  for (size_t i = 0; i < commands.size(); i++) {
+    const DrawCommand& cmd = commands[i];
+    if (camera && in_world(cmd.layer) != world) {
+      world = !world;
+      backend.camera(world ? &*camera : nullptr);
+    }
+    if (cmd.kind == DrawCommand::Sprite) {
+      size_t end = i + 1;
+      while (end < commands.size() && commands[end].kind == DrawCommand::Sprite &&
+             commands[end].layer == cmd.layer) {
+        end++;
+      }
+      backend.sprites(&commands[i], end - i);
+      i = end - 1;
+      continue;
+    }
+    backend.submit(cmd, cmd.kind == DrawCommand::Text ? texts.data() + cmd.text : nullptr);
+  }
+  if (world) backend.camera(nullptr);
+
+  stats.submitted = commands.size();
+  commands.clear();
+  texts.clear();
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "vec2.h"
+
+// Layers are flushed in this order. Background and Overlay are in screen
+// space, everything in between is drawn through the queue's camera if set.
+enum class Layer : uint8_t {
+  Background,
+  Tiles,
+  Markers,
+  Entities,
+  Actors,
+  Overlay,
+};
+
+// Pre-rendered images in the sprite atlas.
+enum class Sprite : uint8_t {
+  Ball,
+  Coin,
+  COUNT,
+};
+
+struct DrawCommand {
+  enum Kind : uint8_t {
+    Rect,
+    RectLines,
+    Circle,
+    CircleLines,
+    Line,
+    Text,
+    Texture,
+    Checker,
+    Sprite,
+    Grid,
+    KIND_COUNT
+  };
+
+  Layer layer;
+  Kind kind;
+  Color color;
+  Rectangle rect;          // Circle: center x, y and radius. Line: from x, y to width, height
+  float thick = 1;         // RectLines
+  int font_size = 0;       // Text
+  uint32_t text = 0;       // Text, offset into the queue's text buffer
+  Texture2D texture = {};  // Texture, drawn from `source` into `rect`
+  Rectangle source = {};
+  Color alt = {};          // Checker, cells with odd (row + col) in map coordinates
+  float cell = 0;          // Checker, Grid spacing
+  ::Sprite sprite = {};    // Sprite, centered at x, y with radius width
+};
+
+class RenderBackend {
+ public:
+  virtual ~RenderBackend() = default;
+  virtual void camera(const Camera2D* camera) = 0;  // null switches back to screen space
+  virtual void submit(const DrawCommand& cmd, const char* text) = 0;
+  // A run of Sprite commands on one layer, submitted one by one unless overridden.
+  virtual void sprites(const DrawCommand* cmds, size_t count);
+};
+
+class RaylibBackend : public RenderBackend {
+ public:
+  void camera(const Camera2D* camera) override;
+  void submit(const DrawCommand& cmd, const char* text) override;
+  void sprites(const DrawCommand* cmds, size_t count) override;
+};
+
+// Counts what would be drawn, for measuring draw work without a window.
+class NullBackend : public RenderBackend {
+ public:
+  size_t calls[DrawCommand::KIND_COUNT] = {};
+  size_t camera_switches = 0;
+  size_t sprite_batches = 0;
+
+  void camera(const Camera2D* camera) override;
+  void submit(const DrawCommand& cmd, const char* text) override;
+  void sprites(const DrawCommand* cmds, size_t count) override;
+  size_t total() const;
+};
+
+// Draw work of one frame. Game code appends commands instead of calling
+// raylib, `flush` orders them by layer (keeping the order within a layer),
+// merges abutting rectangles of the same color and hands them to a backend.
+// Consecutive sprites of a layer go to the backend as one run.
+class RenderQueue {
+ public:
+  struct Stats {
+    size_t recorded = 0;
+    size_t submitted = 0;
+  };
+
+  std::vector<DrawCommand> commands;
+  std::string texts;
+  std::optional<Camera2D> camera;
+  Stats stats;
+
+  void clear();
+  void rect(Layer layer, Rectangle rect, Color color);
+  void rect_lines(Layer layer, Rectangle rect, float thick, Color color);
+  void circle(Layer layer, vec2 center, float radius, Color color);
+  void circle_lines(Layer layer, vec2 center, float radius, Color color);
+  void line(Layer layer, vec2 from, vec2 to, Color color);
+  void text(Layer layer, const std::string& text, vec2 pos, int font_size, Color color);
+  void texture(Layer layer, Texture2D texture, Rectangle source, Rectangle dest, Color tint);
+  void checker(Layer layer, Rectangle rect, float cell, Color even, Color odd);
+  void sprite(Layer layer, Sprite sprite, vec2 center, float radius);
+  void grid(Layer layer, Rectangle rect, float spacing, Color color);
+  void flush(RenderBackend& backend);
+};
@@ -32,22 +32,6 @@ inline void to_json(json& j, Bounds& b) {
   j = json::object({{"min", b.min}, {"max", b.max}});
 }
 
-inline void from_json(const json& j, Circle& c) {
-  j.at("pos").get_to(c.pos);
-  c.pos *= SIZE;
-
-  if (j["move"]["kind"] == "linear") {
-    Bounds bounds = j["move"]["bounds"].template get<Bounds>();
-    bounds.min *= SIZE;
-    bounds.max *= SIZE;
-    c.move = std::make_shared<Linear>(
-      j["move"]["dir"].template get<vec2>().norm(),
-      j["move"]["speed"].template get<float>(),
-      bounds
-    );
-  }
-}
-
 inline void to_json(json& j, const Circle& c) {
   j = {{"pos", c.pos / SIZE}, {"move", json::object()}};
   switch (c.move->kind) {
@@ -61,6 +45,222 @@ inline void to_json(json& j, const Circle& c) {
         {"max", linear->bounds.max / SIZE}
       };
     } break;
+    case Move::Chaser: {
+      j["move"]["kind"] = "chase";
+      j["move"]["speed"] = ((Chaser*)c.move.get())->speed;
+    } break;
     default: break;
   }
 }
+
+// Streaming reader for data.json that fills a level's entity arrays directly,
+// without building a json tree. Positions are converted from tiles to pixels.
+class LevelSax {
+ public:
+  std::string error;
+
+  LevelSax(Level& level) : level(level) {}
+
+  bool null() {
+    return value();
+  }
+
+  bool boolean(bool) {
+    return value();
+  }
+
+  bool number_integer(json::number_integer_t v) {
+    return number(v);
+  }
+
+  bool number_unsigned(json::number_unsigned_t v) {
+    return number(v);
+  }
+
+  bool number_float(json::number_float_t v, const json::string_t&) {
+    return number(v);
+  }
+
+  bool string(json::string_t& s) {
+    if (depth > 0 && stack[depth - 1].key == Key::Move && stack[depth - 1].field == Key::Kind) {
+      ball.kind = s == "linear" ? Move::Linear : s == "chase" ? Move::Chaser : -1;
+    }
+    return value();
+  }
+
+  bool binary(json::binary_t&) {
+    return value();
+  }
+
+  bool start_object(std::size_t) {
+    return push();
+  }
+
+  bool key(json::string_t& s) {
+    Frame& top = stack[depth - 1];
+    top.field = Key::Unknown;
+    switch (top.key) {
+      case Key::Root:
+        if (s == "start") top.field = Key::Start;
+        else if (s == "finish") top.field = Key::Finish;
+        else if (s == "balls") top.field = Key::Balls;
+        else if (s == "coins") top.field = Key::Coins;
+        break;
+      case Key::Ball:
+        if (s == "pos") top.field = Key::Pos;
+        else if (s == "move") top.field = Key::Move;
+        break;
+      case Key::Move:
+        if (s == "kind") top.field = Key::Kind;
+        else if (s == "dir") top.field = Key::Dir;
+        else if (s == "speed") top.field = Key::Speed;
+        else if (s == "bounds") top.field = Key::Bounds;
+        break;
+      case Key::Bounds:
+        if (s == "min") top.field = Key::Min;
+        else if (s == "max") top.field = Key::Max;
+        break;
+      default: break;
+    }
+    return true;
+  }
+
+  bool end_object() {
+    if (stack[--depth].key == Key::Ball) emit_ball();
+    return value();
+  }
+
+  bool start_array(std::size_t) {
+    return push();
+  }
+
+  bool end_array() {
+    if (stack[--depth].key == Key::Coin) level.coins.emplace_back(coin * SIZE);
+    return value();
+  }
+
+  bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) {
+    error = ex.what();
+    return false;
+  }
+
+ private:
+  enum class Key {
+    Unknown,
+    Root,
+    Start,
+    Finish,
+    Balls,
+    Ball,
+    Coins,
+    Coin,
+    Pos,
+    Move,
+    Kind,
+    Dir,
+    Speed,
+    Bounds,
+    Min,
+    Max
+  };
+
+  struct Frame {
+    Key key;
+    Key field;  // objects: key of the value being read
+    int index;  // arrays: index of the value being read
+  };
+
+  struct BallFields {
+    vec2 pos, dir, min, max;
+    float speed = 0;
+    int kind = -1;
+  };
+
+  Level& level;
+  Frame stack[16];
+  int depth = 0;
+  BallFields ball;
+  vec2 coin;
+
+  // What a container opening at the current position holds.
+  Key child() const {
+    if (depth == 0) return Key::Root;
+    const Frame& top = stack[depth - 1];
+    if (top.key == Key::Balls) return Key::Ball;
+    if (top.key == Key::Coins) return Key::Coin;
+    switch (top.key) {
+      case Key::Root:
+      case Key::Ball:
+      case Key::Move:
+      case Key::Bounds: return top.field;
+      default: break;
+    }
+    return Key::Unknown;
+  }
+
+  bool push() {
+    if (depth == 16) {
+      error = "data.json is nested too deeply";
+      return false;
+    }
+    Key key = child();
+    if (key == Key::Ball) ball = {};
+    if (key == Key::Coin) coin = {};
+    stack[depth++] = {key, Key::Unknown, 0};
+    return true;
+  }
+
+  // Every completed value advances the index of an enclosing array.
+  bool value() {
+    if (depth > 0) stack[depth - 1].index++;
+    return true;
+  }
+
+  bool number(double v) {
+    if (depth == 0) return true;
+    const Frame& top = stack[depth - 1];
+    float f = v;
+    int i = top.index;
+
+    switch (top.key) {
+      case Key::Start: set(level.start, i, f * SIZE); break;
+      case Key::Finish: set(level.finish, i, f * SIZE); break;
+      case Key::Coin: set(coin, i, f); break;
+      case Key::Pos: set(ball.pos, i, f); break;
+      case Key::Dir: set(ball.dir, i, f); break;
+      case Key::Min: set(ball.min, i, f); break;
+      case Key::Max: set(ball.max, i, f); break;
+      case Key::Move:
+        if (top.field == Key::Speed) ball.speed = f;
+        break;
+      default: break;
+    }
+    return value();
+  }
+
+  static void set(vec2& v, int i, float f) {
+    if (i == 0) v.x = f;
+    else if (i == 1) v.y = f;
+  }
+
+  static void set(Rectangle& r, int i, float f) {
+    if (i == 0) r.x = f;
+    else if (i == 1) r.y = f;
+    else if (i == 2) r.width = f;
+    else if (i == 3) r.height = f;
+  }
+
+  void emit_ball() {
+    vec2 pos = ball.pos * SIZE;
+    std::shared_ptr<Move> move;
+    switch (ball.kind) {
+      case Move::Linear: {
+        Bounds bounds = {ball.min * SIZE, ball.max * SIZE};
+        move = std::make_shared<Linear>(ball.dir.norm(), ball.speed, bounds);
+      } break;
+      case Move::Chaser: move = std::make_shared<Chaser>(ball.speed, pos); break;
+      default: return;
+    }
+    level.obstacles.push_back({.pos = pos, .prev = pos, .move = move});
+  }
+};
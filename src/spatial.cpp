@@ -0,0 +1,173 @@
+#include "spatial.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+static const int LEAF_SIZE = 4;
+
+static Rectangle merge(Rectangle a, Rectangle b) {
+  float x = std::min(a.x, b.x), y = std::min(a.y, b.y);
+  return {
+    x,
+    y,
+    std::max(a.x + a.width, b.x + b.width) - x,
+    std::max(a.y + a.height, b.y + b.height) - y,
+  };
+}
+
+static vec2 center(Rectangle r) {
+  return {r.x + r.width / 2, r.y + r.height / 2};
+}
+
+// Entry distance of the ray into `r`, FLT_MAX on a miss.
+static float slab(Rectangle r, vec2 origin, vec2 inv, float max_dist) {
+  float tx1 = (r.x - origin.x) * inv.x, tx2 = (r.x + r.width - origin.x) * inv.x;
+  float ty1 = (r.y - origin.y) * inv.y, ty2 = (r.y + r.height - origin.y) * inv.y;
+  float tmin = std::max(std::min(tx1, tx2), std::min(ty1, ty2));
+  float tmax = std::min(std::max(tx1, tx2), std::max(ty1, ty2));
+  tmin = std::max(tmin, 0.0f);
+  if (std::isnan(tmin) || std::isnan(tmax) || tmin > tmax || tmin > max_dist) return FLT_MAX;
+  return tmin;
+}
+
+static float distance_sq(Rectangle r, vec2 p) {
+  float dx = std::max({r.x - p.x, 0.0f, p.x - (r.x + r.width)});
+  float dy = std::max({r.y - p.y, 0.0f, p.y - (r.y + r.height)});
+  return dx * dx + dy * dy;
+}
+
+void SpatialIndex::build(std::vector<Item> items) {
+  this->items = std::move(items);
+  nodes.clear();
+  if (this->items.empty()) return;
+  nodes.reserve(2 * this->items.size() / LEAF_SIZE + 1);
+
+  // Top down median split on the longest axis of the item centers.
+  struct Task {
+    int node, first, count;
+  };
+  std::vector<Task> tasks = {{0, 0, (int)this->items.size()}};
+  nodes.push_back({});
+
+  while (!tasks.empty()) {
+    Task task = tasks.back();
+    tasks.pop_back();
+    auto begin = this->items.begin() + task.first;
+    auto end = begin + task.count;
+
+    Rectangle bounds = begin->bounds;
+    int mask = 0;
+    vec2 lo = center(bounds), hi = lo;
+    for (auto it = begin; it != end; it++) {
+      bounds = merge(bounds, it->bounds);
+      mask |= it->kind;
+      vec2 c = center(it->bounds);
+      lo = {std::min(lo.x, c.x), std::min(lo.y, c.y)};
+      hi = {std::max(hi.x, c.x), std::max(hi.y, c.y)};
+    }
+
+    Node& node = nodes[task.node];
+    node.bounds = bounds;
+    node.mask = mask;
+
+    if (task.count <= LEAF_SIZE) {
+      node.first = task.first;
+      node.count = task.count;
+      continue;
+    }
+
+    bool split_x = hi.x - lo.x >= hi.y - lo.y;
+    int half = task.count / 2;
+    std::nth_element(begin, begin + half, end, [split_x](const Item& a, const Item& b) {
+      return split_x ? center(a.bounds).x < center(b.bounds).x
+                     : center(a.bounds).y < center(b.bounds).y;
+    });
+
+    int left = nodes.size();
+    node.left = left;
+    node.count = 0;
+    nodes.push_back({});
+    nodes.push_back({});
+    tasks.push_back({left, task.first, half});
+    tasks.push_back({left + 1, task.first + half, task.count - half});
+  }
+}
+
+const SpatialIndex::Item* SpatialIndex::raycast(
+  vec2 origin,
+  vec2 dir,
+  float max_dist,
+  int mask,
+  float* dist
+) const {
+  if (nodes.empty()) return nullptr;
+  dir = dir.norm();
+  vec2 inv = {1.0f / dir.x, 1.0f / dir.y};
+
+  const Item* best = nullptr;
+  float best_dist = max_dist;
+  int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+
+  while (top > 0) {
+    const Node& node = nodes[stack[--top]];
+    if (!(node.mask & mask) || slab(node.bounds, origin, inv, best_dist) == FLT_MAX) continue;
+
+    if (node.count == 0) {
+      // Push the farther child first so the nearer one tightens `best_dist` early.
+      float l = slab(nodes[node.left].bounds, origin, inv, best_dist);
+      float r = slab(nodes[node.left + 1].bounds, origin, inv, best_dist);
+      stack[top++] = l < r ? node.left + 1 : node.left;
+      stack[top++] = l < r ? node.left : node.left + 1;
+      continue;
+    }
+
+    for (int i = node.first; i < node.first + node.count; i++) {
+      if (!(items[i].kind & mask)) continue;
+      float t = slab(items[i].bounds, origin, inv, best_dist);
+      if (t != FLT_MAX && t < best_dist) {
+        best = &items[i];
+        best_dist = t;
+      }
+    }
+  }
+
+  if (best && dist) *dist = best_dist;
+  return best;
+}
+
+const SpatialIndex::Item* SpatialIndex::nearest(vec2 point, int mask, float max_dist) const {
+  if (nodes.empty()) return nullptr;
+
+  const Item* best = nullptr;
+  float best_sq = max_dist == FLT_MAX ? FLT_MAX : max_dist * max_dist;
+  int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+
+  while (top > 0) {
+    const Node& node = nodes[stack[--top]];
+    if (!(node.mask & mask) || distance_sq(node.bounds, point) > best_sq) continue;
+
+    if (node.count == 0) {
+      float l = distance_sq(nodes[node.left].bounds, point);
+      float r = distance_sq(nodes[node.left + 1].bounds, point);
+      stack[top++] = l < r ? node.left + 1 : node.left;
+      stack[top++] = l < r ? node.left : node.left + 1;
+      continue;
+    }
+
+    for (int i = node.first; i < node.first + node.count; i++) {
+      if (!(items[i].kind & mask)) continue;
+      float d = distance_sq(items[i].bounds, point);
+      if (d <= best_sq) {
+        best = &items[i];
+        best_sq = d;
+      }
+    }
+  }
+
+  return best;
+}
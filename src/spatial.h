@@ -0,0 +1,65 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cfloat>
+#include <vector>
+
+#include "vec2.h"
+
+// Bounding volume hierarchy over the static parts of a level (merged walls,
+// coins and checkpoints). Built once at load, queries touch O(log n) nodes.
+class SpatialIndex {
+ public:
+  enum Kind {
+    Walls = 1 << 0,
+    Coins = 1 << 1,
+    Checkpoints = 1 << 2,
+    All = Walls | Coins | Checkpoints
+  };
+
+  struct Item {
+    Rectangle bounds;
+    Kind kind;
+    int index;  // into the level array matching `kind`
+  };
+
+  struct Node {
+    Rectangle bounds;
+    int mask;   // union of the kinds below this node
+    int left;   // children are `left` and `left + 1`, unused for leaves
+    int first;  // leaf items are items[first, first + count)
+    int count;  // 0 for inner nodes
+  };
+
+  std::vector<Item> items;
+  std::vector<Node> nodes;
+
+  SpatialIndex() = default;
+
+  void build(std::vector<Item> items);
+
+  // Calls `visit(const Item&)` for every item of `mask` overlapping `box`.
+  template <typename F>
+  void query(Rectangle box, int mask, F&& visit) const {
+    if (nodes.empty()) return;
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const Node& node = nodes[stack[--top]];
+      if (!(node.mask & mask) || !CheckCollisionRecs(node.bounds, box)) continue;
+      if (node.count == 0) {
+        stack[top++] = node.left;
+        stack[top++] = node.left + 1;
+        continue;
+      }
+      for (int i = node.first; i < node.first + node.count; i++) {
+        if ((items[i].kind & mask) && CheckCollisionRecs(items[i].bounds, box)) visit(items[i]);
+      }
+    }
+  }
+
+  const Item* raycast(vec2 origin, vec2 dir, float max_dist, int mask, float* dist = nullptr) const;
+  const Item* nearest(vec2 point, int mask, float max_dist = FLT_MAX) const;
+};
@@ -0,0 +1,36 @@
+#include "tilecache.h"
+
+TileCache::~TileCache() {
+  release();
+}
+
+void TileCache::invalidate() {
+  valid = false;
+}
+
+// Frees the texture, must happen before the window is closed.
+void TileCache::release() {
+  if (target.id != 0) UnloadRenderTexture(target);
+  target = {};
+  valid = false;
+}
+
+void TileCache::render(int width, int height) {
+  if (target.id == 0 || target.texture.width != width || target.texture.height != height) {
+    release();
+    target = LoadRenderTexture(width, height);
+  }
+
+  BeginTextureMode(target);
+  ClearBackground(BLANK);
+  RaylibBackend backend;
+  scratch.flush(backend);
+  EndTextureMode();
+}
+
+void TileCache::draw(RenderQueue& queue) const {
+  if (!valid) return;
+  float w = target.texture.width, h = target.texture.height;
+  // Render textures are stored bottom up.
+  queue.texture(Layer::Tiles, target.texture, {0, 0, w, -h}, {0, 0, w, h}, WHITE);
+}
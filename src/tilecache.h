@@ -0,0 +1,42 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstdint>
+
+#include "render.h"
+
+// The parts of a level that only change when it's edited (tiles, start,
+// finish and checkpoints), rendered once into a texture so a frame draws them
+// as one textured quad instead of a rectangle per tile. Has to be used and
+// released on the thread owning the window.
+class TileCache {
+ public:
+  TileCache() = default;
+  TileCache(const TileCache&) = delete;
+  TileCache& operator=(const TileCache&) = delete;
+  ~TileCache();
+
+  // Re-renders what `record(RenderQueue&)` draws when `revision` differs from the cached one.
+  template <typename F>
+  void update(uint64_t revision, int width, int height, F&& record) {
+    if (valid && revision == this->revision) return;
+    scratch.clear();
+    record(scratch);
+    render(width, height);
+    this->revision = revision;
+    valid = true;
+  }
+
+  void invalidate();
+  void release();
+  void draw(RenderQueue& queue) const;
+
+ private:
+  RenderTexture2D target = {};
+  uint64_t revision = 0;
+  bool valid = false;
+  RenderQueue scratch;
+
+  void render(int width, int height);
+};
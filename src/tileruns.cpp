@@ -0,0 +1,62 @@
+#include "tileruns.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "conf.h"
+
+using conf::SIZE, conf::TILE_COLORS;
+
+void TileRuns::build(const char* tiles, int rows, int cols, int stride) {
+  this->rows.assign(rows, {});
+  for (int r = 0; r < rows; r++) update_row(r, tiles + r * stride, cols);
+}
+
+// Rebuilds a single row after it was edited, `tiles` points at its first tile.
+void TileRuns::update_row(int row, const char* tiles, int cols) {
+  auto& runs = rows[row];
+  runs.clear();
+  for (int c = 0; c < cols;) {
+    if (tiles[c] != '#') {
+      c++;
+      continue;
+    }
+    int end = c;
+    while (end < cols && tiles[end] == '#') end++;
+    runs.push_back({c, end - c});
+    c = end;
+  }
+}
+
+size_t TileRuns::count() const {
+  size_t n = 0;
+  for (const auto& runs : rows) n += runs.size();
+  return n;
+}
+
+void TileRuns::draw(RenderQueue& queue) const {
+  draw(queue, {-1e9f, -1e9f, 2e9f, 2e9f});
+}
+
+// Visits the rows overlapping `view` and clips their runs to it, so the cost
+// follows the view and not the map.
+void TileRuns::draw(RenderQueue& queue, Rectangle view) const {
+  int first = std::max((int)std::floor(view.y / SIZE) - row0, 0);
+  int last = std::min((int)std::ceil((view.y + view.height) / SIZE) - row0, (int)rows.size());
+  int left = (int)std::floor(view.x / SIZE) - col0;
+  int right = (int)std::ceil((view.x + view.width) / SIZE) - col0;
+
+  for (int r = first; r < last; r++) {
+    float y = (row0 + r) * SIZE;
+    const auto& runs = rows[r];
+    // Runs are sorted by column, skip the ones ending left of the view.
+    auto it = std::lower_bound(runs.begin(), runs.end(), left, [](const Run& run, int col) {
+      return run.col + run.length <= col;
+    });
+    for (; it != runs.end() && it->col < right; it++) {
+      int begin = std::max(it->col, left), end = std::min(it->col + it->length, right);
+      Rectangle rect = {(float)(col0 + begin) * SIZE, y, (float)(end - begin) * SIZE, SIZE};
+      queue.checker(Layer::Tiles, rect, SIZE, TILE_COLORS.first, TILE_COLORS.second);
+    }
+  }
+}
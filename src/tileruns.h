@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "render.h"
+
+// Floor tiles merged into maximal horizontal runs per row, each drawn as one
+// checkerboard command. The render queue stacks runs that line up in
+// consecutive rows into rectangles, so a map costs a handful of draws
+// instead of one per tile, without needing a cached texture.
+class TileRuns {
+ public:
+  struct Run {
+    int col;
+    int length;
+  };
+
+  int row0 = 0;  // map position of the first tile, for chunks of a bigger map
+  int col0 = 0;
+  std::vector<std::vector<Run>> rows;
+
+  void build(const char* tiles, int rows, int cols, int stride);
+  void update_row(int row, const char* tiles, int cols);
+  size_t count() const;
+  void draw(RenderQueue& queue) const;
+  void draw(RenderQueue& queue, Rectangle view) const;  // only the tiles inside `view`
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the newest of a stream of values from one writer thread to one reader
+// thread without locks. Each side owns a slot and the third one sits between
+// them, `publish` swaps the written slot in and `fetch` swaps it out, so
+// neither side waits and the reader skips values it was too slow for.
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // Writer side, fill `back()` then publish it.
+  T& back() { return slots[back_index]; }
+
+  void publish() {
+    uint8_t old = middle.exchange(back_index | FRESH, std::memory_order_acq_rel);
+    back_index = old & INDEX;
+  }
+
+  // Reader side, true when a value was published since the last fetch and
+  // `front()` now holds it.
+  bool fetch() {
+    if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+    uint8_t old = middle.exchange(front_index, std::memory_order_acq_rel);
+    front_index = old & INDEX;
+    return true;
+  }
+
+  T& front() { return slots[front_index]; }
+
+ private:
+  static constexpr uint8_t INDEX = 3;
+  static constexpr uint8_t FRESH = 4;
+
+  T slots[3];
+  uint8_t back_index = 0;
+  std::atomic<uint8_t> middle = 1;
+  uint8_t front_index = 2;
+};
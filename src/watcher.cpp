@@ -0,0 +1,94 @@
+#include "watcher.h"
+
+#include <cstring>
+
+#include "level.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+static std::filesystem::file_time_type modified(const std::filesystem::path& path) {
+  std::error_code ec;
+  auto time = std::filesystem::last_write_time(path, ec);
+  return ec ? std::filesystem::file_time_type::min() : time;
+}
+
+static int change_for(const char* name) {
+  if (std::strcmp(name, "data.json") == 0) return Level::Entities;
+  if (std::strcmp(name, "map.txt") == 0) return Level::Tiles;
+  return 0;
+}
+
+static void merge(std::vector<LevelWatcher::Event>& events, size_t id, int changes) {
+  if (!changes) return;
+  for (auto& e : events) {
+    if (e.id == id) {
+      e.changes |= changes;
+      return;
+    }
+  }
+  events.push_back({id, changes});
+}
+
+LevelWatcher::~LevelWatcher() {
+#ifdef __linux__
+  if (fd != -1) close(fd);
+#endif
+}
+
+void LevelWatcher::add(const std::filesystem::path& dir, size_t id) {
+  Watch watch = {dir, id, modified(dir / "data.json"), modified(dir / "map.txt")};
+
+#ifdef __linux__
+  if (fd == -1) fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd != -1) {
+    // Editors either rewrite in place or rename a temporary over the original.
+    int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd != -1) {
+      watches[wd] = watch;
+      return;
+    }
+  }
+#endif
+
+  watches[-1 - (int)watches.size()] = watch;
+}
+
+std::vector<LevelWatcher::Event> LevelWatcher::poll() {
+  std::vector<Event> events;
+
+#ifdef __linux__
+  if (fd != -1) {
+    alignas(inotify_event) char buffer[4096];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+      for (char* p = buffer; p < buffer + n;) {
+        auto* e = (inotify_event*)p;
+        auto it = watches.find(e->wd);
+        if (it != watches.end() && e->len > 0) merge(events, it->second.id, change_for(e->name));
+        p += sizeof(inotify_event) + e->len;
+      }
+    }
+  }
+#endif
+
+  // Polled watches are stat'ed at most twice a second.
+  auto now = std::chrono::steady_clock::now();
+  if (now - last_poll < std::chrono::milliseconds(500)) return events;
+  last_poll = now;
+
+  for (auto& [key, watch] : watches) {
+    if (key >= 0) continue;
+    auto data_time = modified(watch.dir / "data.json");
+    auto map_time = modified(watch.dir / "map.txt");
+    int changes = (data_time != watch.data_time ? Level::Entities : 0) |
+                  (map_time != watch.map_time ? Level::Tiles : 0);
+    watch.data_time = data_time;
+    watch.map_time = map_time;
+    merge(events, watch.id, changes);
+  }
+
+  return events;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+// Reports edits to the data.json / map.txt of watched level directories.
+// Uses inotify on Linux and falls back to polling modification times elsewhere.
+class LevelWatcher {
+ public:
+  struct Event {
+    size_t id;
+    int changes;  // Level::Change flags
+  };
+
+  LevelWatcher() = default;
+  LevelWatcher(const LevelWatcher&) = delete;
+  LevelWatcher& operator=(const LevelWatcher&) = delete;
+  ~LevelWatcher();
+
+  void add(const std::filesystem::path& dir, size_t id);
+  std::vector<Event> poll();  // never blocks, edits to the same level are merged
+
+ private:
+  struct Watch {
+    std::filesystem::path dir;
+    size_t id;
+    std::filesystem::file_time_type data_time;
+    std::filesystem::file_time_type map_time;
+  };
+
+  int fd = -1;
+  std::unordered_map<int, Watch> watches;  // by inotify descriptor, or insertion order when polling
+  std::chrono::steady_clock::time_point last_poll;
+};
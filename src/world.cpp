@@ -0,0 +1,409 @@
+#include "world.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "conf.h"
+#include "mapcodec.h"
+
+using conf::SIZE, conf::CHECKPOINT_COLOR;
+
+World::World(const std::filesystem::path& path, size_t budget)
+    : budget(std::max<size_t>(budget, 9)) {
+  auto fail = [&path] { throw std::runtime_error(path.string() + ": missing or invalid world"); };
+  if (!file.open(path) || file.size < sizeof(Header)) fail();
+
+  const Header* h = (const Header*)file.data;
+  uint64_t chunks = (uint64_t)h->chunk_rows * h->chunk_cols;
+  if (std::memcmp(h->magic, MAGIC, 4) != 0 || h->version != VERSION || h->size != file.size ||
+      h->rows == 0 || h->cols == 0 || h->chunk_rows != (h->rows + CHUNK - 1) / CHUNK ||
+      h->chunk_cols != (h->cols + CHUNK - 1) / CHUNK || h->entries_offset % 4 != 0 ||
+      h->entries_offset + chunks * sizeof(Entry) > file.size) {
+    fail();
+  }
+
+  header = h;
+  entries = (const Entry*)(file.data + h->entries_offset);
+  rows = h->rows;
+  cols = h->cols;
+  chunk_rows = h->chunk_rows;
+  chunk_cols = h->chunk_cols;
+  start = h->start;
+  finish = h->finish;
+  respawn = start;
+  collected.assign(h->coin_count, 0);
+  coins_left = h->coin_count;
+  slots.resize(chunks);
+
+  loader = std::thread(&World::run, this);
+}
+
+World::~World() {
+  {
+    std::lock_guard lock(mutex);
+    quit = true;
+  }
+  wake.notify_all();
+  loader.join();
+}
+
+Rectangle World::bounds() const {
+  return {0, 0, (float)cols * SIZE, (float)rows * SIZE};
+}
+
+size_t World::resident_count() const {
+  return resident.size();
+}
+
+bool World::ready(Rectangle area) const {
+  int r0 = std::clamp((int)(area.y / SIZE), 0, rows - 1) >> CHUNK_SHIFT;
+  int r1 = std::clamp((int)((area.y + area.height) / SIZE), 0, rows - 1) >> CHUNK_SHIFT;
+  int c0 = std::clamp((int)(area.x / SIZE), 0, cols - 1) >> CHUNK_SHIFT;
+  int c1 = std::clamp((int)((area.x + area.width) / SIZE), 0, cols - 1) >> CHUNK_SHIFT;
+  for (int r = r0; r <= r1; r++) {
+    for (int c = c0; c <= c1; c++) {
+      if (!slots[r * chunk_cols + c]) return false;
+    }
+  }
+  return true;
+}
+
+void World::collect(Chunk& chunk, size_t coin) {
+  if (chunk.coins[coin].collected) return;
+  chunk.coins[coin].collected = true;
+  collected[chunk.coin_base + coin] = 1;
+  coins_left--;
+}
+
+// Runs on the loader thread, only reads the mapping. A corrupt chunk comes
+// back as solid wall so the rest of the world stays playable.
+std::unique_ptr<World::Chunk> World::decode(int id) const {
+  auto chunk = std::make_unique<Chunk>();
+  const Entry& e = entries[id];
+  chunk->id = id;
+  chunk->coin_base = e.coin_base;
+  std::memset(chunk->tiles, '.', sizeof(chunk->tiles));
+
+  auto corrupt = [&] {
+    fprintf(stderr, "world: chunk %d is corrupt\n", id);
+    return std::move(chunk);
+  };
+
+  if (e.offset % 4 != 0 || e.size < sizeof(ChunkHeader) + sizeof(chunk->tiles) ||
+      (uint64_t)e.offset + e.size > file.size) {
+    return corrupt();
+  }
+
+  const char* p = file.data + e.offset;
+  const ChunkHeader* h = (const ChunkHeader*)p;
+  uint64_t size = sizeof(ChunkHeader) + sizeof(chunk->tiles) +
+                  (uint64_t)h->ball_count * sizeof(LevelFile::Ball) +
+                  (uint64_t)h->coin_count * sizeof(Vector2) +
+                  (uint64_t)h->checkpoint_count * sizeof(Rectangle);
+  if (size != e.size || (uint64_t)e.coin_base + h->coin_count > header->coin_count ||
+      (uint64_t)e.checkpoint_base + h->checkpoint_count > header->checkpoint_count) {
+    return corrupt();
+  }
+
+  p += sizeof(ChunkHeader);
+  std::memcpy(chunk->tiles, p, sizeof(chunk->tiles));
+  p += sizeof(chunk->tiles);
+  chunk->runs.row0 = id / chunk_cols * CHUNK;
+  chunk->runs.col0 = id % chunk_cols * CHUNK;
+  chunk->runs.build(chunk->tiles, CHUNK, CHUNK, CHUNK);
+
+  const LevelFile::Ball* balls = (const LevelFile::Ball*)p;
+  chunk->obstacles.reserve(h->ball_count);
+  for (uint32_t i = 0; i < h->ball_count; i++) {
+    Circle circle;
+    if (LevelFile::unpack(balls[i], circle)) chunk->obstacles.push_back(std::move(circle));
+  }
+  p += h->ball_count * sizeof(LevelFile::Ball);
+
+  const Vector2* coins = (const Vector2*)p;
+  chunk->coins.reserve(h->coin_count);
+  for (uint32_t i = 0; i < h->coin_count; i++) chunk->coins.emplace_back(coins[i]);
+  p += h->coin_count * sizeof(Vector2);
+
+  const Rectangle* checkpoints = (const Rectangle*)p;
+  chunk->checkpoints.assign(checkpoints, checkpoints + h->checkpoint_count);
+  return chunk;
+}
+
+void World::run() {
+  std::unique_lock lock(mutex);
+  while (true) {
+    wake.wait(lock, [this] { return quit || !requests.empty(); });
+    if (quit) return;
+    int id = requests.front();
+    requests.erase(requests.begin());
+
+    lock.unlock();
+    auto chunk = decode(id);
+    lock.lock();
+    loaded.push_back(std::move(chunk));
+  }
+}
+
+// Squared distance in chunks from the focus.
+int World::distance(int id) const {
+  int dr = id / chunk_cols - focus_id / chunk_cols;
+  int dc = id % chunk_cols - focus_id % chunk_cols;
+  return dr * dr + dc * dc;
+}
+
+// Move finished chunks in, dropping the ones the player has already left.
+void World::adopt() {
+  std::vector<std::unique_ptr<Chunk>> ready;
+  {
+    std::lock_guard lock(mutex);
+    ready.swap(loaded);
+  }
+
+  for (auto& chunk : ready) {
+    int id = chunk->id;
+    if (slots[id] || std::find(wanted.begin(), wanted.end(), id) == wanted.end()) continue;
+    for (size_t i = 0; i < chunk->coins.size(); i++) {
+      chunk->coins[i].collected = collected[chunk->coin_base + i];
+    }
+    resident.push_back(id);
+    slots[id] = std::move(chunk);
+  }
+}
+
+// Unload the farthest chunks until the budget holds.
+void World::evict() {
+  if (resident.size() <= budget) return;
+  std::sort(resident.begin(), resident.end(), [this](int a, int b) {
+    return distance(a) < distance(b);
+  });
+  while (resident.size() > budget) {
+    slots[resident.back()].reset();
+    resident.pop_back();
+  }
+}
+
+// Stream in the chunks around `pos`, called once per frame with the player position.
+void World::focus(vec2 pos) {
+  int row = std::clamp((int)(pos.y / SIZE), 0, rows - 1);
+  int col = std::clamp((int)(pos.x / SIZE), 0, cols - 1);
+  int id = (row >> CHUNK_SHIFT) * chunk_cols + (col >> CHUNK_SHIFT);
+
+  if (id != focus_id) {
+    focus_id = id;
+
+    // The 5x5 block of chunks around the focus, nearest first and cut to the budget.
+    wanted.clear();
+    int cr = id / chunk_cols, cc = id % chunk_cols;
+    for (int r = std::max(cr - 2, 0); r <= std::min(cr + 2, chunk_rows - 1); r++) {
+      for (int c = std::max(cc - 2, 0); c <= std::min(cc + 2, chunk_cols - 1); c++) {
+        wanted.push_back(r * chunk_cols + c);
+      }
+    }
+    std::sort(wanted.begin(), wanted.end(), [this](int a, int b) {
+      return distance(a) < distance(b);
+    });
+    if (wanted.size() > budget) wanted.resize(budget);
+
+    {
+      std::lock_guard lock(mutex);
+      requests.clear();
+      for (int want : wanted) {
+        if (!slots[want]) requests.push_back(want);
+      }
+    }
+    wake.notify_one();
+  }
+
+  adopt();
+  evict();
+}
+
+void World::reset() {
+  respawn = start;
+  std::fill(collected.begin(), collected.end(), 0);
+  coins_left = collected.size();
+  for (int id : resident) {
+    for (auto& coin : slots[id]->coins) coin.collected = false;
+  }
+}
+
+void World::set_player(vec2& pos, vec2 size) {
+  pos.x = respawn.x + respawn.width / 2 - size.x / 2;
+  pos.y = respawn.y + respawn.height / 2 - size.y / 2;
+}
+
+void World::update(float dt) {
+  for (int id : resident) {
+    for (auto& obs : slots[id]->obstacles) obs.update(dt);
+  }
+}
+
+void World::capture(
+  std::vector<EntityState>& entities,
+  std::vector<std::shared_ptr<const Chunk>>& chunks,
+  Rectangle area
+) const {
+  for (int id : resident) {
+    const auto& chunk = slots[id];
+    chunks.push_back(chunk);
+    // Balls move away from the chunk they spawned in, so each entity is tested.
+    for (const auto& obs : chunk->obstacles) {
+      if (!CheckCollisionCircleRec(obs.pos, obs.radius, area)) continue;
+      entities.push_back({obs.pos, obs.prev, obs.radius, Sprite::Ball});
+    }
+    for (const auto& coin : chunk->coins) {
+      if (coin.collected || !CheckCollisionCircleRec(coin.pos, coin.radius, area)) continue;
+      entities.push_back({coin.pos, coin.pos, coin.radius, Sprite::Coin});
+    }
+  }
+}
+
+void World::draw_static(
+  RenderQueue& queue,
+  Rectangle view,
+  const std::vector<std::shared_ptr<const Chunk>>& chunks
+) const {
+  float side = CHUNK * SIZE;
+  for (const auto& chunk : chunks) {
+    const TileRuns& runs = chunk->runs;
+    Rectangle area = {runs.col0 * (float)SIZE, runs.row0 * (float)SIZE, side, side};
+    if (!CheckCollisionRecs(area, view)) continue;
+    runs.draw(queue, view);
+    for (Rectangle check : chunk->checkpoints) {
+      if (CheckCollisionRecs(check, view)) queue.rect(Layer::Markers, check, CHECKPOINT_COLOR);
+    }
+  }
+  for (Rectangle rect : {start, finish}) {
+    if (CheckCollisionRecs(rect, view)) queue.rect(Layer::Markers, rect, CHECKPOINT_COLOR);
+  }
+}
+
+// Chunk a level straight from its sources. Only one chunk row of the map is in
+// memory at a time, so the map may be bigger than RAM. The entities are read
+// whole and each goes to the chunk its position falls in. Unlike a Level, a
+// world isn't checked for reachability since that needs the whole map.
+bool World::write(const std::filesystem::path& dir, const std::filesystem::path& path) {
+  MapReader map(dir / "map.txt");
+  Level level = Level::entities(dir);
+
+  Header h = {};
+  std::memcpy(h.magic, MAGIC, 4);
+  h.version = VERSION;
+  h.rows = map.rows;
+  h.cols = map.cols;
+  h.chunk_rows = (h.rows + CHUNK - 1) / CHUNK;
+  h.chunk_cols = (h.cols + CHUNK - 1) / CHUNK;
+  h.coin_count = level.coins.size();
+  h.checkpoint_count = level.checkpoints.size();
+  h.entries_offset = sizeof(Header);
+  h.start = level.start;
+  h.finish = level.finish;
+
+  size_t chunks = (size_t)h.chunk_rows * h.chunk_cols;
+  auto chunk_of = [&](Vector2 pos) {
+    int r = std::clamp((int)(pos.y / SIZE), 0, (int)h.rows - 1);
+    int c = std::clamp((int)(pos.x / SIZE), 0, (int)h.cols - 1);
+    return (size_t)(r >> CHUNK_SHIFT) * h.chunk_cols + (c >> CHUNK_SHIFT);
+  };
+
+  // Sorted by chunk so every chunk's entities are one slice, taken in order.
+  std::vector<LevelFile::Ball> balls;
+  for (const auto& obs : level.obstacles) balls.push_back(LevelFile::pack(obs));
+  std::vector<Vector2> coins;
+  for (const auto& coin : level.coins) coins.push_back(coin.pos);
+  std::vector<Rectangle> checkpoints = level.checkpoints;
+  auto by_chunk = [&](auto& items, auto pos_of) {
+    std::stable_sort(items.begin(), items.end(), [&](const auto& a, const auto& b) {
+      return chunk_of(pos_of(a)) < chunk_of(pos_of(b));
+    });
+  };
+  auto ball_pos = [](const LevelFile::Ball& ball) { return ball.pos; };
+  auto coin_pos = [](Vector2 pos) { return pos; };
+  auto checkpoint_pos = [](Rectangle rect) { return Vector2{rect.x, rect.y}; };
+  by_chunk(balls, ball_pos);
+  by_chunk(coins, coin_pos);
+  by_chunk(checkpoints, checkpoint_pos);
+
+  std::filesystem::path tmp = path;
+  tmp += ".tmp";
+  std::ofstream out(tmp, std::ios::binary);
+  if (!out.is_open()) return false;
+
+  std::vector<Entry> entries(chunks);
+  uint64_t size = sizeof(Header) + chunks * sizeof(Entry);
+  out.seekp(size);
+
+  // The slice of `items` that falls in chunk `id` starts at `next`, returns its length.
+  auto slice = [&](const auto& items, size_t next, size_t id, auto pos_of) {
+    size_t end = next;
+    while (end < items.size() && chunk_of(pos_of(items[end])) == id) end++;
+    return (uint32_t)(end - next);
+  };
+  auto emit = [&](const auto& items, size_t& next, uint32_t count) {
+    out.write((const char*)(items.data() + next), count * sizeof(items[0]));
+    next += count;
+  };
+
+  int band_cols = h.chunk_cols * CHUNK;
+  std::vector<char> band(CHUNK * band_cols);  // one chunk row of tiles
+  size_t next_ball = 0, next_coin = 0, next_checkpoint = 0;
+  uint32_t coin_base = 0, checkpoint_base = 0;
+
+  // A malformed map row only shows up halfway through, don't leave the partial file behind.
+  try {
+    for (uint32_t chunk_row = 0; chunk_row < h.chunk_rows; chunk_row++) {
+      std::fill(band.begin(), band.end(), '.');
+      for (int y = 0; y < CHUNK && map.next(); y++) {
+        std::copy(map.row.begin(), map.row.end(), band.begin() + y * band_cols);
+      }
+
+      for (uint32_t chunk_col = 0; chunk_col < h.chunk_cols; chunk_col++) {
+        size_t id = chunk_row * h.chunk_cols + chunk_col;
+        Entry& e = entries[id];
+        e.offset = size;
+        e.coin_base = coin_base;
+        e.checkpoint_base = checkpoint_base;
+
+        ChunkHeader ch = {};
+        ch.ball_count = slice(balls, next_ball, id, ball_pos);
+        ch.coin_count = slice(coins, next_coin, id, coin_pos);
+        ch.checkpoint_count = slice(checkpoints, next_checkpoint, id, checkpoint_pos);
+        out.write((const char*)&ch, sizeof(ch));
+        for (int y = 0; y < CHUNK; y++) {
+          out.write(band.data() + y * band_cols + chunk_col * CHUNK, CHUNK);
+        }
+        emit(balls, next_ball, ch.ball_count);
+        emit(coins, next_coin, ch.coin_count);
+        emit(checkpoints, next_checkpoint, ch.checkpoint_count);
+
+        size += sizeof(ch) + CHUNK * CHUNK + ch.ball_count * sizeof(LevelFile::Ball) +
+                ch.coin_count * sizeof(Vector2) + ch.checkpoint_count * sizeof(Rectangle);
+        if (size > UINT32_MAX) throw std::runtime_error(path.string() + ": world is over 4 GiB");
+        e.size = size - e.offset;
+        coin_base += ch.coin_count;
+        checkpoint_base += ch.checkpoint_count;
+      }
+    }
+    while (map.next()) {}  // so rows past the expected count still fail
+  } catch (...) {
+    out.close();
+    std::error_code ec;
+    std::filesystem::remove(tmp, ec);
+    throw;
+  }
+
+  h.size = size;
+  out.seekp(0);
+  out.write((const char*)&h, sizeof(h));
+  out.write((const char*)entries.data(), chunks * sizeof(Entry));
+  out.close();
+  if (!out) return false;
+
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  return !ec;
+}
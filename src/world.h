@@ -0,0 +1,151 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "level.h"
+#include "levelfile.h"
+#include "mapped.h"
+
+// A level bigger than one screen, split into square chunks of tiles plus the
+// entities spawned on them. A background thread decodes the chunks around the
+// player and at most `budget` of them stay resident; everything else reads as
+// wall and isn't simulated or drawn. Positions are in pixels.
+//
+//   Header | Entry[chunk_rows * chunk_cols] | chunks, each:
+//   ChunkHeader | tiles (CHUNK * CHUNK chars) | Ball[] | Vector2[] coins | Rectangle[] checkpoints
+class World {
+ public:
+  static constexpr const char* NAME = "world.bin";
+  static constexpr char MAGIC[4] = {'T', 'W', 'L', 'D'};
+  static constexpr uint32_t VERSION = 1;
+  static constexpr int CHUNK_SHIFT = 5;
+  static constexpr int CHUNK = 1 << CHUNK_SHIFT;  // tiles per chunk side
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t size;  // of the whole file
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t chunk_rows;
+    uint32_t chunk_cols;
+    uint32_t coin_count;
+    uint32_t checkpoint_count;
+    uint32_t entries_offset;
+    Rectangle start;
+    Rectangle finish;
+  };
+
+  struct Entry {
+    uint32_t offset;
+    uint32_t size;
+    uint32_t coin_base;        // world index of the chunk's first coin
+    uint32_t checkpoint_base;  // world index of the chunk's first checkpoint
+  };
+
+  struct ChunkHeader {
+    uint32_t ball_count;
+    uint32_t coin_count;
+    uint32_t checkpoint_count;
+    uint32_t reserved;
+  };
+
+  // Tiles, runs and checkpoints don't change after decoding, so drawing may
+  // read them on another thread. Balls and coins belong to the simulation.
+  struct Chunk {
+    int id;
+    uint32_t coin_base;
+    char tiles[CHUNK * CHUNK];
+    TileRuns runs;
+    std::vector<Circle> obstacles;
+    std::vector<Coin> coins;
+    std::vector<Rectangle> checkpoints;
+  };
+
+  int rows = 0;
+  int cols = 0;
+  Rectangle start;
+  Rectangle finish;
+  Rectangle respawn;            // start or the last checkpoint reached
+  std::vector<char> collected;  // per world coin, survives its chunk being unloaded
+  int coins_left = 0;
+
+  World(const std::filesystem::path& path, size_t budget = 16);
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+  ~World();
+
+  // Tiles of chunks that aren't resident are walls, so nothing walks into them.
+  char get(int row, int col) const {
+    if ((unsigned)row >= (unsigned)rows || (unsigned)col >= (unsigned)cols) return '.';
+    const Chunk* chunk = slots[(row >> CHUNK_SHIFT) * chunk_cols + (col >> CHUNK_SHIFT)].get();
+    if (!chunk) return '.';
+    return chunk->tiles[((row & (CHUNK - 1)) << CHUNK_SHIFT) + (col & (CHUNK - 1))];
+  }
+
+  // Calls `visit(Chunk&)` for every resident chunk.
+  template <typename F>
+  void each_chunk(F&& visit) {
+    for (int id : resident) visit(*slots[id]);
+  }
+
+  Rectangle bounds() const;
+  size_t resident_count() const;
+  bool ready(Rectangle area) const;  // whether every chunk under `area` is resident
+  void collect(Chunk& chunk, size_t coin);
+  void focus(vec2 pos);
+  // Back to a fresh roam, from the start with every coin in place.
+  void reset();
+  void set_player(vec2& pos, vec2 size);
+  void update(float dt);
+  // Appends the resident chunks and their entities overlapping `area`. The
+  // chunks stay valid after they are unloaded, for drawing on another thread.
+  void capture(
+    std::vector<EntityState>& entities,
+    std::vector<std::shared_ptr<const Chunk>>& chunks,
+    Rectangle area
+  ) const;
+  // Floor and checkpoints of captured chunks, start and finish.
+  void draw_static(
+    RenderQueue& queue,
+    Rectangle view,
+    const std::vector<std::shared_ptr<const Chunk>>& chunks
+  ) const;
+
+  // Chunks the level in `dir` into a world file at `path`, streaming the map.
+  static bool write(const std::filesystem::path& dir, const std::filesystem::path& path);
+
+ private:
+  MappedFile file;
+  const Header* header = nullptr;
+  const Entry* entries = nullptr;
+  int chunk_rows = 0;
+  int chunk_cols = 0;
+  size_t budget;
+  int focus_id = -1;
+  std::vector<std::shared_ptr<Chunk>> slots;  // by chunk id, null unless resident
+  std::vector<int> resident;
+  std::vector<int> wanted;  // nearest first
+
+  // Shared with the loader thread.
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::vector<int> requests;
+  std::vector<std::unique_ptr<Chunk>> loaded;
+  bool quit = false;
+  std::thread loader;
+
+  std::unique_ptr<Chunk> decode(int id) const;
+  int distance(int id) const;
+  void adopt();
+  void evict();
+  void run();
+};
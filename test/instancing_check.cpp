@@ -0,0 +1,67 @@
+#include <raylib.h>
+#include <rlgl.h>
+
+#include <cstdio>
+
+#include "../src/instancing.h"
+
+// Draws one instanced sprite into a hidden window and reads the screen back.
+// Catches shader or winding mistakes that leave the sprite culled, runs on
+// llvmpipe too (LIBGL_ALWAYS_SOFTWARE=1). Part of `make check`, skipped where
+// no window can be opened.
+
+const int size = 64;
+
+bool lit(Image screen, int x, int y) {
+  Color c = GetImageColor(screen, x, y);
+  return c.r > 200 && c.g < 50 && c.b < 50;
+}
+
+int main() {
+  SetTraceLogLevel(LOG_WARNING);
+  SetConfigFlags(FLAG_WINDOW_HIDDEN);
+  InitWindow(size, size, "instancing");
+  if (!IsWindowReady()) {
+    printf("SKIP: no window\n");
+    return 0;
+  }
+
+  Image white = GenImageColor(1, 1, WHITE);
+  Texture2D atlas = LoadTextureFromImage(white);
+  UnloadImage(white);
+
+  SpriteInstancer instancer;
+  if (!instancer.ready()) {
+    printf("SKIP: instancing shader didn't compile\n");
+    CloseWindow();
+    return 0;
+  }
+
+  // Through a camera like the game, a bit off center so a flipped quad misses.
+  Camera2D camera = {{size / 2.0f, size / 2.0f}, {100, 100}, 0, 2};
+  SpriteInstancer::Instance instance = {104, 100, 8, RED};
+
+  BeginDrawing();
+  ClearBackground(BLACK);
+  BeginMode2D(camera);
+  instancer.upload(&instance, 1);
+  instancer.draw(atlas, {0, 0, 1, 1}, 0, 1);
+  EndMode2D();
+  rlDrawRenderBatchActive();
+  Image screen = LoadImageFromScreen();
+  EndDrawing();
+
+  // The sprite covers screen x 24..56, y 16..48.
+  bool inside = lit(screen, 40, 32) && lit(screen, 26, 18) && lit(screen, 54, 46);
+  bool outside = !lit(screen, 20, 32) && !lit(screen, 40, 12) && !lit(screen, 60, 32);
+  UnloadImage(screen);
+  UnloadTexture(atlas);
+  CloseWindow();
+
+  if (!inside || !outside) {
+    printf("FAIL: instanced sprite %s\n", inside ? "drawn out of place" : "missing");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "../src/conf.h"
+#include "../src/level.h"
+#include "../src/raycast.h"
+
+// Casts a fan of rays from every floor tile of the stock levels, once through
+// the batched call and once ray by ray, and checks both agree and stop on a
+// wall. Prints the batched throughput. Run with `make check` from the
+// repository root.
+
+using conf::SIZE;
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+  if (ok) return;
+  printf("FAIL: %s\n", what);
+  failures++;
+}
+
+const int FAN = 64;
+
+void check(const Level& level) {
+  std::vector<GridRay> rays;
+  for (int r = 0; r < level.rows; r++) {
+    for (int c = 0; c < level.cols; c++) {
+      if (level.get(r, c) != '#') continue;
+      vec2 center = {(c + 0.5f) * SIZE, (r + 0.5f) * SIZE};
+      for (int i = 0; i < FAN; i++) {
+        float angle = 2 * PI * i / FAN;
+        rays.push_back({center, {std::cos(angle), std::sin(angle)}, 1e6});
+      }
+    }
+  }
+
+  std::vector<RayHit> hits;
+  raycast(level, rays, hits);
+  expect(hits.size() == rays.size(), "one hit per ray");
+
+  bool same = true, walls = true;
+  for (size_t i = 0; i < rays.size(); i++) {
+    RayHit one = raycast(level, rays[i].origin, rays[i].dir, rays[i].max_dist);
+    same &= one.hit == hits[i].hit && one.dist == hits[i].dist && one.row == hits[i].row &&
+            one.col == hits[i].col;
+    walls &= hits[i].hit && level.get(hits[i].row, hits[i].col) == '.';
+  }
+  expect(same, "batched rays match single ones");
+  expect(walls, "every ray stops on a wall");
+
+  // A short ray between two floor tiles next to each other never hits.
+  bool clear = true;
+  for (int r = 0; r < level.rows; r++) {
+    for (int c = 0; c + 1 < level.cols; c++) {
+      if (level.get(r, c) != '#' || level.get(r, c + 1) != '#') continue;
+      vec2 a = {(c + 0.5f) * SIZE, (r + 0.5f) * SIZE};
+      clear &= line_of_sight(level, a, a + vec2(SIZE, 0));
+    }
+  }
+  expect(clear, "neighbouring floor tiles see each other");
+
+  auto start = std::chrono::steady_clock::now();
+  int rounds = 20;
+  for (int i = 0; i < rounds; i++) raycast(level, rays, hits);
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                .count();
+  printf("%zu rays, %.0f per ms batched\n", rays.size(), rays.size() * rounds / ms);
+}
+
+int main() {
+  check(Level(1));
+  check(Level(2));
+
+  if (failures) return 1;
+  printf("OK\n");
+  return 0;
+}
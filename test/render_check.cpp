@@ -0,0 +1,69 @@
+#include <cstdio>
+
+#include "../src/conf.h"
+#include "../src/level.h"
+#include "../src/render.h"
+
+// Records level 1 the way the game draws a frame and flushes it into a
+// NullBackend, so the draw counts are checked without a window. Run with
+// `make check` from the repository root.
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+  if (ok) return;
+  printf("FAIL: %s\n", what);
+  failures++;
+}
+
+int main() {
+  Level level(1);
+  std::vector<EntityState> entities;
+  level.capture(entities, level.bounds());
+
+  RenderQueue queue;
+  queue.camera = Camera2D{{0, 0}, {0, 0}, 0, 1};
+  queue.grid(Layer::Background, level.bounds(), conf::SIZE, conf::GRID_COLOR);
+  level.draw_static(queue, level.bounds());
+  for (const auto& entity : entities) entity.draw(queue, 1);
+
+  size_t floor = 0;
+  for (int r = 0; r < level.rows; r++) {
+    for (int c = 0; c < level.cols; c++) floor += level.get(r, c) == '#';
+  }
+  size_t runs = level.runs.count();
+
+  NullBackend backend;
+  queue.flush(backend);
+
+  printf("recorded %zu, submitted %zu\n", queue.stats.recorded, queue.stats.submitted);
+  printf(
+    "%zu floor tiles, %zu runs, %zu checker draws\n",
+    floor,
+    runs,
+    backend.calls[DrawCommand::Checker]
+  );
+  printf("%zu sprites in %zu runs\n", backend.calls[DrawCommand::Sprite], backend.sprite_batches);
+
+  expect(
+    queue.stats.recorded == 1 + runs + 2 + entities.size(),
+    "one command per floor run, marker and entity"
+  );
+  expect(queue.stats.submitted == backend.total(), "stats match what the backend saw");
+  expect(queue.commands.empty(), "flush empties the queue");
+  expect(backend.calls[DrawCommand::Grid] == 1, "the grid is one draw");
+
+  // Runs that line up in consecutive rows are stacked into one checker.
+  expect(backend.calls[DrawCommand::Checker] > 0, "floor is drawn");
+  expect(backend.calls[DrawCommand::Checker] <= runs, "checkers never exceed the runs");
+  expect(backend.calls[DrawCommand::Checker] < floor / 4, "floor isn't drawn per tile");
+
+  // Balls and coins share the entity layer, so they go out as one instanced run.
+  expect(backend.calls[DrawCommand::Sprite] == entities.size(), "every entity is a sprite");
+  expect(backend.sprite_batches == (entities.empty() ? 0 : 1), "entities are one sprite run");
+  expect(backend.camera_switches == 2, "into the world and back out once");
+
+  if (failures) return 1;
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+
+#include "../src/conf.h"
+#include "../src/level.h"
+#include "../src/raycast.h"
+#include "../src/spatial.h"
+
+// Runs ray and nearest queries against the spatial index of the stock levels.
+// Rays through the wall boxes must stop where the grid raycast does, rays at
+// coins and checkpoints and nearest must agree with a scan over every item.
+// Run with `make check` from the repository root.
+
+using conf::SIZE;
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+  if (ok) return;
+  printf("FAIL: %s\n", what);
+  failures++;
+}
+
+float distance_sq(Rectangle r, vec2 p) {
+  float dx = std::max({r.x - p.x, 0.0f, p.x - (r.x + r.width)});
+  float dy = std::max({r.y - p.y, 0.0f, p.y - (r.y + r.height)});
+  return dx * dx + dy * dy;
+}
+
+// Entry distance of the ray into `r`, FLT_MAX on a miss.
+float entry(Rectangle r, vec2 origin, vec2 dir) {
+  float t0 = 0, t1 = FLT_MAX;
+  float lo[2] = {r.x, r.y}, hi[2] = {r.x + r.width, r.y + r.height};
+  float o[2] = {origin.x, origin.y}, d[2] = {dir.x, dir.y};
+  for (int axis = 0; axis < 2; axis++) {
+    if (d[axis] == 0) {
+      if (o[axis] < lo[axis] || o[axis] > hi[axis]) return FLT_MAX;
+      continue;
+    }
+    float a = (lo[axis] - o[axis]) / d[axis], b = (hi[axis] - o[axis]) / d[axis];
+    t0 = std::max(t0, std::min(a, b));
+    t1 = std::min(t1, std::max(a, b));
+  }
+  return t0 <= t1 ? t0 : FLT_MAX;
+}
+
+void check(const Level& level) {
+  const SpatialIndex& index = level.index;
+  int rays = 0;
+  bool same = true, scan = true, nearest = true, none = true;
+  int markers = SpatialIndex::Coins | SpatialIndex::Checkpoints;
+
+  for (int r = 0; r < level.rows; r++) {
+    for (int c = 0; c < level.cols; c++) {
+      if (level.get(r, c) != '#') continue;
+      // Off center and at odd angles, so no ray runs exactly through a tile corner.
+      vec2 origin = {(c + 0.37f) * SIZE, (r + 0.61f) * SIZE};
+
+      for (int i = 0; i < 32; i++) {
+        float angle = 0.1f + 2 * PI * i / 32;
+        vec2 dir = {std::cos(angle), std::sin(angle)};
+        RayHit grid = raycast(level, origin, dir, 1e6);
+        bool inside = grid.row >= 0 && grid.row < level.rows && grid.col >= 0 &&
+                      grid.col < level.cols;
+
+        // The index only holds walls inside the map, past the border rays miss.
+        float dist = 0;
+        auto hit = index.raycast(origin, dir, FLT_MAX, SpatialIndex::Walls, &dist);
+        same &= inside ? hit && std::fabs(dist - grid.dist) < 0.01f : !hit;
+
+        float best = FLT_MAX;
+        for (const auto& item : index.items) {
+          if (item.kind & markers) best = std::min(best, entry(item.bounds, origin, dir));
+        }
+        hit = index.raycast(origin, dir, FLT_MAX, markers, &dist);
+        scan &= best == FLT_MAX ? !hit : hit && std::fabs(dist - best) < 0.01f;
+        rays++;
+      }
+
+      for (int mask : {(int)SpatialIndex::Walls, markers}) {
+        float best = FLT_MAX;
+        for (const auto& item : index.items) {
+          if (item.kind & mask) best = std::min(best, distance_sq(item.bounds, origin));
+        }
+        const SpatialIndex::Item* found = index.nearest(origin, mask);
+        nearest &= best == FLT_MAX ? !found : found && distance_sq(found->bounds, origin) == best;
+      }
+
+      // Too short to leave the floor tile, so there is nothing to hit.
+      none &= !index.raycast(origin, {1, 0}, 0.1f * SIZE, SpatialIndex::Walls);
+    }
+  }
+
+  printf("%d rays against %zu boxes in %zu nodes\n", rays, index.items.size(), index.nodes.size());
+  expect(rays > 0, "the level has floor");
+  expect(same, "index rays stop where grid rays do");
+  expect(scan, "rays at coins and checkpoints match a full scan");
+  expect(nearest, "nearest matches a full scan");
+  expect(none, "short rays within a floor tile miss");
+}
+
+int main() {
+  check(Level(1));
+  check(Level(2));
+
+  if (failures) return 1;
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "../src/level.h"
+#include "../src/levelfile.h"
+#include "../src/levelpack.h"
+#include "../src/world.h"
+
+namespace fs = std::filesystem;
+
+static void usage() {
+  fprintf(stderr, "usage: levelconv bin <level dir>...\n");
+  fprintf(stderr, "       levelconv text [--rle] <level dir>...\n");
+  fprintf(stderr, "       levelconv pack <out> <level dir>...\n");
+  fprintf(stderr, "       levelconv embed <out.cpp> <level dir>...\n");
+  fprintf(stderr, "       levelconv world <out> <level dir>\n");
+  fprintf(stderr, "  bin   data.json + map.txt -> %s\n", LevelFile::NAME);
+  fprintf(stderr, "  text  %s -> data.json + map.txt\n", LevelFile::NAME);
+  fprintf(stderr, "        --rle writes map.txt run length encoded\n");
+  fprintf(stderr, "  pack  level dirs, in order -> single pack file\n");
+  fprintf(stderr, "  embed level dirs, in order -> C++ source defining EMBEDDED_LEVELS\n");
+  fprintf(stderr, "  world one level of any size -> chunked %s for streaming\n", World::NAME);
+}
+
+static bool to_bin(const fs::path& dir) {
+  Level level(dir);
+  if (!LevelFile::write(level, dir / LevelFile::NAME)) {
+    fprintf(stderr, "%s: could not write %s\n", dir.c_str(), LevelFile::NAME);
+    return false;
+  }
+  return true;
+}
+
+static bool to_text(const fs::path& dir, bool rle) {
+  LevelFile file;
+  if (!file.open(dir / LevelFile::NAME)) {
+    fprintf(stderr, "%s: missing or invalid %s\n", dir.c_str(), LevelFile::NAME);
+    return false;
+  }
+  Level level(file, dir.string());
+  level.save(dir, rle);
+  return true;
+}
+
+// Emit the pack image as a byte array so it can be linked into the game.
+static bool embed(const std::vector<fs::path>& dirs, const fs::path& out) {
+  std::vector<char> bytes = LevelPack::encode(dirs);
+  std::ofstream f(out);
+  if (!f.is_open()) return false;
+
+  f << "// Generated by levelconv, do not edit.\n";
+  f << "#include <cstddef>\n\n";
+  f << "alignas(8) extern const unsigned char EMBEDDED_LEVELS[] = {";
+  for (size_t i = 0; i < bytes.size(); i++) {
+    if (i % 16 == 0) f << "\n ";
+    f << ' ' << (int)(unsigned char)bytes[i] << ',';
+  }
+  f << "\n};\n";
+  f << "extern const size_t EMBEDDED_LEVELS_SIZE = " << bytes.size() << ";\n";
+  f.close();
+  return (bool)f;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+
+  if (strcmp(argv[1], "world") == 0) {
+    if (argc != 4) {
+      usage();
+      return 1;
+    }
+    try {
+      if (World::write(argv[3], argv[2])) return 0;
+      fprintf(stderr, "%s: could not write world\n", argv[2]);
+    } catch (const std::exception& e) {
+      fprintf(stderr, "%s: %s\n", argv[3], e.what());
+    }
+    return 1;
+  }
+
+  bool pack = strcmp(argv[1], "pack") == 0;
+  if (pack || strcmp(argv[1], "embed") == 0) {
+    if (argc < 4) {
+      usage();
+      return 1;
+    }
+    std::vector<fs::path> dirs(argv + 3, argv + argc);
+    try {
+      if (pack ? LevelPack::write(dirs, argv[2]) : embed(dirs, argv[2])) return 0;
+      fprintf(stderr, "%s: could not write %s\n", argv[2], pack ? "pack" : "source");
+    } catch (const std::exception& e) {
+      fprintf(stderr, "%s: %s\n", argv[2], e.what());
+    }
+    return 1;
+  }
+
+  bool bin = strcmp(argv[1], "bin") == 0;
+  if (!bin && strcmp(argv[1], "text") != 0) {
+    usage();
+    return 1;
+  }
+
+  bool rle = !bin && argc > 2 && strcmp(argv[2], "--rle") == 0;
+  int failed = 0;
+  for (int i = rle ? 3 : 2; i < argc; i++) {
+    try {
+      if (!(bin ? to_bin(argv[i]) : to_text(argv[i], rle))) failed++;
+    } catch (const std::exception& e) {
+      fprintf(stderr, "%s: %s\n", argv[i], e.what());
+      failed++;
+    }
+  }
+
+  return failed == 0 ? 0 : 1;
+}